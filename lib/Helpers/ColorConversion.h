@@ -0,0 +1,67 @@
+#include <Arduino.h>
+#include <inttypes.h>
+#include <algorithm>
+
+#ifndef _COLOR_CONVERSION_H
+#define _COLOR_CONVERSION_H
+
+/*
+ * Integer RGB <-> HSV conversions.  These give the same results as RGBConverter (within
+ * one unit, from how the float version rounds exact halves) without touching floating
+ * point, which is emulated in software on the ESP8266.
+ */
+class ColorConversion {
+public:
+  // Hue in [0, 360], saturation in [0, 100].  Both rounded to nearest.
+  static void rgbToHsv(uint8_t r, uint8_t g, uint8_t b, uint16_t& hue, uint8_t& saturation) {
+    const uint8_t max = std::max(std::max(r, g), b);
+    const uint8_t min = std::min(std::min(r, g), b);
+    const uint32_t delta = max - min;
+
+    saturation = max == 0 ? 0 : (200 * delta + max) / (2 * max);
+
+    if (delta == 0) {
+      hue = 0;
+      return;
+    }
+
+    // Numerator of hue * delta.  Offsets keep it non-negative so it can be rounded
+    // with unsigned division.
+    uint32_t scaled;
+    if (max == r) {
+      scaled = 60 * static_cast<int32_t>(g - b) + (g < b ? 360 * delta : 0);
+    } else if (max == g) {
+      scaled = 60 * static_cast<int32_t>(b - r) + 120 * delta;
+    } else {
+      scaled = 60 * static_cast<int32_t>(r - g) + 240 * delta;
+    }
+
+    hue = (2 * scaled + delta) / (2 * delta);
+  }
+
+  // Full value.  Hue in [0, 360], saturation in [0, 100].  Channels are truncated.
+  static void hsvToRgb(uint16_t hue, uint8_t saturation, uint8_t rgb[3]) {
+    hue %= 360;
+    saturation = std::min(saturation, static_cast<uint8_t>(100));
+
+    const uint8_t sector = hue / 60;
+    const uint32_t remainder = hue - sector * 60;
+
+    // v * (1 - s), v * (1 - f*s), v * (1 - (1-f)*s) with f = remainder / 60
+    const uint8_t v = 255;
+    const uint8_t p = (255 * static_cast<uint32_t>(100 - saturation)) / 100;
+    const uint8_t q = (255 * (6000 - remainder * saturation)) / 6000;
+    const uint8_t t = (255 * (6000 - (60 - remainder) * saturation)) / 6000;
+
+    switch (sector) {
+      case 0: rgb[0] = v; rgb[1] = t; rgb[2] = p; break;
+      case 1: rgb[0] = q; rgb[1] = v; rgb[2] = p; break;
+      case 2: rgb[0] = p; rgb[1] = v; rgb[2] = t; break;
+      case 3: rgb[0] = p; rgb[1] = q; rgb[2] = v; break;
+      case 4: rgb[0] = t; rgb[1] = p; rgb[2] = v; break;
+      default: rgb[0] = v; rgb[1] = p; rgb[2] = q; break;
+    }
+  }
+};
+
+#endif
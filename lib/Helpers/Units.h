@@ -10,9 +10,11 @@
 
 class Units {
 public:
+  // Rounds to nearest.  Integer math only -- floats are emulated in software on the
+  // ESP8266.  value must be non-negative.
   template <typename T, typename V>
-  static T rescale(T value, V newMax, float oldMax = 255.0) {
-    return round(value * (newMax / oldMax));
+  static T rescale(T value, V newMax, uint32_t oldMax = 255) {
+    return (2 * static_cast<uint32_t>(value) * newMax + oldMax) / (2 * oldMax);
   }
 
   static uint8_t miredsToWhiteVal(uint16_t mireds, uint8_t maxValue = 255) {
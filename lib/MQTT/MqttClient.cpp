@@ -12,9 +12,10 @@ static const char* STATUS_CONNECTED = "connected";
 static const char* STATUS_DISCONNECTED = "disconnected_clean";
 static const char* STATUS_LWT_DISCONNECTED = "disconnected_unclean";
 
-MqttClient::MqttClient(Settings& settings, MiLightClient*& milightClient)
+MqttClient::MqttClient(Settings& settings, MiLightClient*& milightClient, SceneController& scenes)
   : mqttClient(tcpClient),
     milightClient(milightClient),
+    scenes(scenes),
     settings(settings),
     lastConnectAttempt(0),
     connected(false)
@@ -124,6 +125,7 @@ void MqttClient::reconnect() {
 void MqttClient::handleClient() {
   reconnect();
   mqttClient.loop();
+  handleDeferredMessages();
 
   if (!connected && mqttClient.connected()) {
     this->connected = true;
@@ -156,6 +158,10 @@ void MqttClient::subscribe() {
 #endif
 
   mqttClient.subscribe(topic.c_str());
+
+  if (settings.mqttSceneTopic.length() > 0) {
+    mqttClient.subscribe(settings.mqttSceneTopic.c_str());
+  }
 }
 
 void MqttClient::send(const char* topic, const char* message, const bool retain) {
@@ -208,9 +214,6 @@ void MqttClient::publish(
 }
 
 void MqttClient::publishCallback(char* topic, byte* payload, int length) {
-  uint16_t deviceId = 0;
-  uint8_t groupId = 0;
-  const MiLightRemoteConfig* config = &FUT092Config;
   char cstrPayload[length + 1];
   cstrPayload[length] = 0;
   memcpy(cstrPayload, payload, sizeof(byte)*length);
@@ -219,6 +222,38 @@ void MqttClient::publishCallback(char* topic, byte* payload, int length) {
   printf("MqttClient - Got message on topic: %s\n%s\n", topic, cstrPayload);
 #endif
 
+  // Hold on to commands while the packet queue is full rather than having them
+  // silently dropped.  Also defer if others are already waiting to preserve order.
+  if (deferredMessages.size() > 0 || milightClient->isBackpressured()) {
+    if (deferredMessages.size() >= MQTT_MAX_DEFERRED_MESSAGES) {
+      Serial.println(F("MqttClient - WARNING: too many deferred commands, dropping oldest"));
+      deferredMessages.shift();
+    }
+
+    deferredMessages.add(DeferredMessage{ topic, cstrPayload });
+    return;
+  }
+
+  handleMessage(topic, cstrPayload);
+}
+
+void MqttClient::handleDeferredMessages() {
+  while (deferredMessages.size() > 0 && !milightClient->isBackpressured()) {
+    DeferredMessage message = deferredMessages.shift();
+    handleMessage(message.topic.c_str(), message.payload.c_str());
+  }
+}
+
+void MqttClient::handleMessage(const char* topic, const char* payload) {
+  if (settings.mqttSceneTopic.length() > 0 && settings.mqttSceneTopic == topic) {
+    handleSceneMessage(payload);
+    return;
+  }
+
+  uint16_t deviceId = 0;
+  uint8_t groupId = 0;
+  const MiLightRemoteConfig* config = &FUT092Config;
+
   auto patternIterator = std::make_shared<TokenIterator>(settings.mqttTopicPattern.c_str(), settings.mqttTopicPattern.length(), '/');
   auto topicIterator = std::make_shared<TokenIterator>(topic, strlen(topic), '/');
   UrlTokenBindings tokenBindings(patternIterator, topicIterator);
@@ -263,7 +298,7 @@ void MqttClient::publishCallback(char* topic, byte* payload, int length) {
   }
 
   StaticJsonDocument<400> buffer;
-  deserializeJson(buffer, cstrPayload);
+  deserializeJson(buffer, payload);
   JsonObject obj = buffer.as<JsonObject>();
 
 #ifdef MQTT_DEBUG
@@ -314,4 +349,18 @@ String MqttClient::generateConnectionStatusMessage(const char* connectionStatus)
 
     return response;
   }
-}
\ No newline at end of file
+}
+
+void MqttClient::handleSceneMessage(const char* payload) {
+  // Accept either the scene's id or its name
+  char* end;
+  const long id = strtol(payload, &end, 10);
+  const Scene* scene = (end != payload && *end == 0) ? scenes.get(id) : scenes.findByName(payload);
+
+  if (scene == NULL) {
+    Serial.printf_P(PSTR("MqttClient - WARNING: could not find scene: `%s'. Ignoring message.\n"), payload);
+    return;
+  }
+
+  scenes.activate(*scene);
+}
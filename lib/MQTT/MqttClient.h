@@ -3,6 +3,8 @@
 #include <PubSubClient.h>
 #include <WiFiClient.h>
 #include <MiLightRadioConfig.h>
+#include <LinkedList.h>
+#include <SceneController.h>
 
 #ifndef MQTT_CONNECTION_ATTEMPT_FREQUENCY
 #define MQTT_CONNECTION_ATTEMPT_FREQUENCY 5000
@@ -12,6 +14,12 @@
 #define MQTT_PACKET_CHUNK_SIZE 128
 #endif
 
+// Number of commands to hold on to while the packet queue is backpressured.  The
+// oldest deferred command is dropped when this is exceeded.
+#ifndef MQTT_MAX_DEFERRED_MESSAGES
+#define MQTT_MAX_DEFERRED_MESSAGES 10
+#endif
+
 #ifndef _MQTT_CLIENT_H
 #define _MQTT_CLIENT_H
 
@@ -19,7 +27,7 @@ class MqttClient {
 public:
   using OnConnectFn = std::function<void()>;
 
-  MqttClient(Settings& settings, MiLightClient*& milightClient);
+  MqttClient(Settings& settings, MiLightClient*& milightClient, SceneController& scenes);
   ~MqttClient();
 
   void begin();
@@ -33,19 +41,29 @@ public:
   String bindTopicString(const String& topicPattern, const BulbId& bulbId);
 
 private:
+  struct DeferredMessage {
+    String topic;
+    String payload;
+  };
+
   WiFiClient tcpClient;
   PubSubClient mqttClient;
   MiLightClient*& milightClient;
+  SceneController& scenes;
   Settings& settings;
   char* domain;
   unsigned long lastConnectAttempt;
   OnConnectFn onConnectFn;
   bool connected;
+  LinkedList<DeferredMessage> deferredMessages;
 
   void sendBirthMessage();
   bool connect();
   void subscribe();
   void publishCallback(char* topic, byte* payload, int length);
+  void handleMessage(const char* topic, const char* payload);
+  void handleSceneMessage(const char* payload);
+  void handleDeferredMessages();
   void publish(
     const String& topic,
     const MiLightRemoteConfig& remoteConfig,
@@ -36,21 +36,34 @@ void CctPacketFormatter::initializePacket(uint8_t* packet) {
   // Byte 9: CRC MSB
 }
 
+void CctPacketFormatter::parsePacketHeader(const uint8_t* packet, uint16_t& deviceId, uint8_t& sequenceNum) {
+  deviceId = (packet[1] << 8) | packet[2];
+
+  // Last byte is the checksum, sequence number precedes it
+  sequenceNum = packet[5];
+}
+
+size_t CctPacketFormatter::getSequenceNumIndex() const {
+  return 5;
+}
+
 void CctPacketFormatter::finalizePacket(uint8_t* packet) {
   uint8_t checksum;
 
   // Calculate checksum over packet length .. sequenceNum
   checksum = 7; // Packet length is not part of packet
   for (uint8_t i = 0; i < 6; i++) {
-    checksum += currentPacket[i];
+    checksum += packet[i];
   }
   // Store the checksum in the sixth byte
-  currentPacket[6] = checksum;
+  packet[6] = checksum;
 }
 
 void CctPacketFormatter::updateBrightness(uint8_t value) {
   const GroupState* state = this->stateStore->get(deviceId, groupId, MiLightRemoteType::REMOTE_TYPE_CCT);
-  int8_t knownValue = (state != NULL && state->isSetBrightness()) ? state->getBrightness() / CCT_INTERVALS : -1;
+  int8_t knownValue = (state != NULL && state->isStepPositionTrusted(GroupStateField::BRIGHTNESS))
+    ? state->getBrightness() / CCT_INTERVALS
+    : -1;
 
   valueByStepFunction(
     &PacketFormatter::increaseBrightness,
@@ -63,7 +76,9 @@ void CctPacketFormatter::updateBrightness(uint8_t value) {
 
 void CctPacketFormatter::updateTemperature(uint8_t value) {
   const GroupState* state = this->stateStore->get(deviceId, groupId, MiLightRemoteType::REMOTE_TYPE_CCT);
-  int8_t knownValue = (state != NULL && state->isSetKelvin()) ? state->getKelvin() / CCT_INTERVALS : -1;
+  int8_t knownValue = (state != NULL && state->isStepPositionTrusted(GroupStateField::KELVIN))
+    ? state->getKelvin() / CCT_INTERVALS
+    : -1;
 
   valueByStepFunction(
     &PacketFormatter::increaseTemperature,
@@ -79,7 +94,7 @@ void CctPacketFormatter::command(uint8_t command, uint8_t arg) {
   if (held) {
     command |= 0x80;
   }
-  currentPacket[CCT_COMMAND_INDEX] = command;
+  currentPacket()[CCT_COMMAND_INDEX] = command;
 }
 
 void CctPacketFormatter::updateStatus(MiLightStatus status, uint8_t groupId) {
@@ -47,10 +47,14 @@ public:
   virtual void initializePacket(uint8_t* packet);
   virtual void finalizePacket(uint8_t* packet);
   virtual BulbId parsePacket(const uint8_t* packet, JsonObject result);
+  virtual void parsePacketHeader(const uint8_t* packet, uint16_t& deviceId, uint8_t& sequenceNum);
 
   static uint8_t getCctStatusButton(uint8_t groupId, MiLightStatus status);
   static uint8_t cctCommandIdToGroup(uint8_t command);
   static MiLightStatus cctCommandToStatus(uint8_t command);
+
+protected:
+  virtual size_t getSequenceNumIndex() const;
 };
 
 #endif
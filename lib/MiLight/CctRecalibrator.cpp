@@ -0,0 +1,90 @@
+#include <CctRecalibrator.h>
+#include <Size.h>
+
+static const GroupStateField STEP_FIELDS[] = {
+  GroupStateField::BRIGHTNESS,
+  GroupStateField::KELVIN
+};
+
+CctRecalibrator::CctRecalibrator(MiLightClient& client, GroupStateStore& stateStore, PacketSender& packetSender, const Settings& settings)
+  : client(client)
+  , stateStore(stateStore)
+  , packetSender(packetSender)
+  , settings(settings)
+  , lastActivity(0)
+{ }
+
+void CctRecalibrator::recordActivity() {
+  lastActivity = millis();
+}
+
+void CctRecalibrator::handle() {
+  if (settings.cctRecalibrateInterval == 0
+    || packetSender.isSending()
+    || (millis() - lastActivity) < MILIGHT_CCT_RECALIBRATE_QUIET_PERIOD) {
+    return;
+  }
+
+  for (ListNode<GroupCacheNode*>* node = stateStore.getCachedStates(); node != NULL; node = node->next) {
+    const BulbId& bulbId = node->data->id;
+    const GroupState& state = node->data->state;
+
+    // Group 0 isn't a real bulb, and anything not known to be off would be noticed
+    if (bulbId.deviceType != REMOTE_TYPE_CCT
+      || bulbId.groupId == 0
+      || !state.isSetState()
+      || state.getState() != OFF
+      || state.isNightMode()) {
+      continue;
+    }
+
+    for (size_t i = 0; i < size(STEP_FIELDS); ++i) {
+      if (needsRecalibration(state, STEP_FIELDS[i])) {
+        recalibrate(BulbId(bulbId));
+        return;
+      }
+    }
+  }
+}
+
+bool CctRecalibrator::needsRecalibration(const GroupState& state, GroupStateField field) const {
+  // Nothing to resync to
+  if (!state.isSetField(field)) {
+    return false;
+  }
+
+  return !state.isStepPositionTrusted(field)
+    || state.getStepPositionAge(field) >= settings.cctRecalibrateInterval;
+}
+
+void CctRecalibrator::recalibrate(const BulbId& bulbId) {
+  GroupState* state = stateStore.get(bulbId);
+
+#ifdef DEBUG_PRINTF
+  Serial.printf_P(PSTR("Recalibrating CCT bulb 0x%04X / %d\n"), bulbId.deviceId, bulbId.groupId);
+#endif
+
+  client.prepare(REMOTE_TYPE_CCT, bulbId.deviceId, bulbId.groupId);
+  client.updateStatus(ON);
+
+  for (size_t i = 0; i < size(STEP_FIELDS); ++i) {
+    GroupStateField field = STEP_FIELDS[i];
+
+    if (!needsRecalibration(*state, field)) {
+      continue;
+    }
+
+    // Forces the formatter to drive the bulb to an extreme before stepping back to the
+    // tracked value.
+    state->invalidateStepPosition(field);
+
+    if (field == GroupStateField::BRIGHTNESS) {
+      client.updateBrightness(state->getBrightness());
+    } else {
+      client.updateTemperature(state->getKelvin());
+    }
+  }
+
+  client.updateStatus(OFF);
+  lastActivity = millis();
+}
@@ -0,0 +1,46 @@
+#include <Arduino.h>
+#include <MiLightClient.h>
+#include <GroupStateStore.h>
+#include <PacketSender.h>
+#include <Settings.h>
+
+#ifndef _CCT_RECALIBRATOR_H
+#define _CCT_RECALIBRATOR_H
+
+// Recalibration only happens once no packets have been sent or heard for this long
+#ifndef MILIGHT_CCT_RECALIBRATE_QUIET_PERIOD
+#define MILIGHT_CCT_RECALIBRATE_QUIET_PERIOD (5UL * 60UL * 1000UL)
+#endif
+
+/*
+ * CCT bulbs only understand brightness and temperature up/down commands.  The gateway
+ * tracks where each bulb is (see GroupState::isStepPositionTrusted), and when it isn't
+ * confident it has to drive the bulb to an extreme and back, which costs up to 20
+ * commands and is visible.
+ *
+ * When enabled, this finds CCT bulbs that are off and whose position is untrusted or
+ * hasn't been calibrated in `cct_recalibrate_interval` minutes, and resyncs them while
+ * the gateway is idle: turn on, recalibrate to the tracked values, turn off.  At most
+ * one bulb is handled per quiet period.
+ */
+class CctRecalibrator {
+public:
+  CctRecalibrator(MiLightClient& client, GroupStateStore& stateStore, PacketSender& packetSender, const Settings& settings);
+
+  // Call whenever a packet is sent or received
+  void recordActivity();
+
+  void handle();
+
+private:
+  MiLightClient& client;
+  GroupStateStore& stateStore;
+  PacketSender& packetSender;
+  const Settings& settings;
+  unsigned long lastActivity;
+
+  bool needsRecalibration(const GroupState& state, GroupStateField field) const;
+  void recalibrate(const BulbId& bulbId);
+};
+
+#endif
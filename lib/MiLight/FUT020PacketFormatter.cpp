@@ -6,7 +6,7 @@ void FUT020PacketFormatter::updateColorRaw(uint8_t color) {
 }
 
 void FUT020PacketFormatter::updateHue(uint16_t hue) {
-  uint16_t remapped = Units::rescale<uint16_t, uint16_t>(hue, 255.0, 360.0);
+  uint16_t remapped = Units::rescale<uint16_t, uint16_t>(hue, 255, 360);
   remapped = (remapped + 0xB0) % 0x100;
 
   updateColorRaw(remapped);
@@ -78,7 +78,7 @@ BulbId FUT020PacketFormatter::parsePacket(const uint8_t* packet, JsonObject resu
       break;
 
     case FUT020Command::COLOR:
-      uint16_t remappedColor = Units::rescale<uint16_t, uint16_t>(packet[FUT02xPacketFormatter::FUT02X_ARGUMENT_INDEX], 360.0, 255.0);
+      uint16_t remappedColor = Units::rescale<uint16_t, uint16_t>(packet[FUT02xPacketFormatter::FUT02X_ARGUMENT_INDEX], 360, 255);
       remappedColor = (remappedColor + 113) % 360;
       result[GroupStateFieldNames::HUE] = remappedColor;
       break;
@@ -25,8 +25,8 @@ void FUT02xPacketFormatter::command(uint8_t command, uint8_t arg) {
   if (held) {
     command |= 0x10;
   }
-  currentPacket[FUT02X_COMMAND_INDEX] = command;
-  currentPacket[FUT02X_ARGUMENT_INDEX] = arg;
+  currentPacket()[FUT02X_COMMAND_INDEX] = command;
+  currentPacket()[FUT02X_ARGUMENT_INDEX] = arg;
 }
 
 void FUT02xPacketFormatter::pair() {
@@ -3,6 +3,7 @@
 #ifndef _FUT089_PACKET_FORMATTER_H
 #define _FUT089_PACKET_FORMATTER_H
 
+#define FUT089_PROTOCOL_ID 0x25
 #define FUT089_COLOR_OFFSET 0
 
 enum MiLightFUT089Command {
@@ -24,7 +25,7 @@ enum MiLightFUT089Arguments {
 class FUT089PacketFormatter : public V2PacketFormatter {
 public:
   FUT089PacketFormatter()
-    : V2PacketFormatter(REMOTE_TYPE_FUT089, 0x25, 8)    // protocol is 0x25, and there are 8 groups
+    : V2PacketFormatter(REMOTE_TYPE_FUT089, FUT089_PROTOCOL_ID, 8)    // protocol is 0x25, and there are 8 groups
   { }
 
   virtual void updateBrightness(uint8_t value);
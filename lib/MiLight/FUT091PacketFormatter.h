@@ -3,6 +3,8 @@
 #ifndef _FUT091_PACKET_FORMATTER_H
 #define _FUT091_PACKET_FORMATTER_H
 
+#define FUT091_PROTOCOL_ID 0x21
+
 enum class FUT091Command {
   ON_OFF = 0x01,
   BRIGHTNESS = 0x2,
@@ -12,7 +14,7 @@ enum class FUT091Command {
 class FUT091PacketFormatter : public V2PacketFormatter {
 public:
   FUT091PacketFormatter()
-    : V2PacketFormatter(REMOTE_TYPE_FUT091, 0x21, 4)    // protocol is 0x21, and there are 4 groups
+    : V2PacketFormatter(REMOTE_TYPE_FUT091, FUT091_PROTOCOL_ID, 4)    // protocol is 0x21, and there are 4 groups
   { }
 
   virtual void updateBrightness(uint8_t value);
@@ -0,0 +1,108 @@
+#include <ListenScheduler.h>
+#include <algorithm>
+
+ListenScheduler::ListenScheduler()
+  : burstConfig(NUM_CONFIGS)
+  , lastHit(0)
+  , burstStart(0)
+  , lastDecay(0)
+{
+  for (size_t i = 0; i < NUM_CONFIGS; i++) {
+    stats[i].polls = 0;
+    stats[i].hits = 0;
+    preferred[i] = false;
+    trafficScore[i] = 0;
+    currentWeight[i] = 0;
+  }
+}
+
+void ListenScheduler::setPreferred(size_t configIx, bool preferred) {
+  if (configIx < NUM_CONFIGS) {
+    this->preferred[configIx] = preferred;
+  }
+}
+
+void ListenScheduler::clearPreferred() {
+  for (size_t i = 0; i < NUM_CONFIGS; i++) {
+    preferred[i] = false;
+  }
+}
+
+size_t ListenScheduler::nextConfig() {
+  unsigned long now = millis();
+
+  if (now - lastDecay >= MILIGHT_LISTEN_DECAY_INTERVAL) {
+    decay();
+    lastDecay = now;
+  }
+
+  if (burstConfig < NUM_CONFIGS) {
+    if ((now - lastHit) < MILIGHT_LISTEN_BURST_WINDOW && (now - burstStart) < MILIGHT_LISTEN_MAX_BURST) {
+      return burstConfig;
+    }
+
+    burstConfig = NUM_CONFIGS;
+  }
+
+  int16_t totalWeight = 0;
+  size_t selected = 0;
+
+  for (size_t i = 0; i < NUM_CONFIGS; i++) {
+    uint8_t weight = getWeight(i);
+
+    currentWeight[i] += weight;
+    totalWeight += weight;
+
+    if (currentWeight[i] > currentWeight[selected]) {
+      selected = i;
+    }
+  }
+
+  currentWeight[selected] -= totalWeight;
+
+  return selected;
+}
+
+void ListenScheduler::recordPoll(size_t configIx) {
+  if (configIx < NUM_CONFIGS) {
+    stats[configIx].polls++;
+  }
+}
+
+void ListenScheduler::recordHit(size_t configIx) {
+  if (configIx >= NUM_CONFIGS) {
+    return;
+  }
+
+  unsigned long now = millis();
+
+  stats[configIx].hits++;
+  trafficScore[configIx] = std::min(trafficScore[configIx] + HIT_SCORE, 255);
+
+  if (burstConfig != configIx) {
+    burstConfig = configIx;
+    burstStart = now;
+  }
+
+  lastHit = now;
+}
+
+uint8_t ListenScheduler::getWeight(size_t configIx) const {
+  if (configIx >= NUM_CONFIGS) {
+    return 0;
+  }
+
+  return 1
+    + (preferred[configIx] ? PREFERRED_WEIGHT : 0)
+    + (trafficScore[configIx] / SCORE_PER_WEIGHT);
+}
+
+const ListenScheduler::ConfigStats& ListenScheduler::getStats(size_t configIx) const {
+  return stats[configIx];
+}
+
+void ListenScheduler::decay() {
+  for (size_t i = 0; i < NUM_CONFIGS; i++) {
+    trafficScore[i] /= 2;
+  }
+}
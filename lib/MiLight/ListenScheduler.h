@@ -0,0 +1,82 @@
+#include <Arduino.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <MiLightRadioConfig.h>
+
+#ifndef _LISTEN_SCHEDULER_H
+#define _LISTEN_SCHEDULER_H
+
+// Keep listening on a config for this long after it last produced a packet.  Remotes
+// send a burst of repeats per press, and presses tend to come in quick succession.
+#ifndef MILIGHT_LISTEN_BURST_WINDOW
+#define MILIGHT_LISTEN_BURST_WINDOW 500
+#endif
+
+// Upper bound on how long a continuous burst can hold the scheduler on one config
+#ifndef MILIGHT_LISTEN_MAX_BURST
+#define MILIGHT_LISTEN_MAX_BURST 5000
+#endif
+
+// Traffic scores are halved this often so that weights follow recent activity
+#ifndef MILIGHT_LISTEN_DECAY_INTERVAL
+#define MILIGHT_LISTEN_DECAY_INTERVAL (60UL * 1000UL)
+#endif
+
+/*
+ * Decides which radio config handleListen should poll next.
+ *
+ * Configs are visited with smooth weighted round-robin, so each gets a share of the
+ * listen time proportional to its weight while still being interleaved with the
+ * others.  Every config has a base weight of 1 so remotes we don't know about yet
+ * are still heard.  Configs used by a configured remote type get a fixed bonus, and
+ * configs that recently produced packets get a bonus proportional to their traffic.
+ *
+ * After a hit, the scheduler stays on the same config for a short burst window.
+ */
+class ListenScheduler {
+public:
+  static const size_t NUM_CONFIGS = MiLightRadioConfig::NUM_CONFIGS;
+
+  // Weight bonus for configs used by a configured remote type
+  static const uint8_t PREFERRED_WEIGHT = 4;
+
+  // Traffic score added per hit, and the divisor converting score to weight
+  static const uint8_t HIT_SCORE = 16;
+  static const uint8_t SCORE_PER_WEIGHT = 16;
+
+  struct ConfigStats {
+    uint32_t polls;
+    uint32_t hits;
+  };
+
+  ListenScheduler();
+
+  // Mark a config as being used by a remote type we have configured
+  void setPreferred(size_t configIx, bool preferred);
+  void clearPreferred();
+
+  // Index into MiLightRadioConfig::ALL_CONFIGS to listen on next
+  size_t nextConfig();
+
+  // Record that a config was polled, and that a recognized packet was heard on it
+  void recordPoll(size_t configIx);
+  void recordHit(size_t configIx);
+
+  uint8_t getWeight(size_t configIx) const;
+  const ConfigStats& getStats(size_t configIx) const;
+
+private:
+  ConfigStats stats[NUM_CONFIGS];
+  bool preferred[NUM_CONFIGS];
+  uint8_t trafficScore[NUM_CONFIGS];
+  int16_t currentWeight[NUM_CONFIGS];
+
+  size_t burstConfig;
+  unsigned long lastHit;
+  unsigned long burstStart;
+  unsigned long lastDecay;
+
+  void decay();
+};
+
+#endif
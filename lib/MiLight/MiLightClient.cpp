@@ -1,68 +1,16 @@
 #include <MiLightClient.h>
 #include <MiLightRadioConfig.h>
 #include <Arduino.h>
-#include <RGBConverter.h>
 #include <Units.h>
 #include <TokenIterator.h>
 #include <ParsedColor.h>
 #include <MiLightCommands.h>
+#include <IntParsing.h>
 #include <functional>
+#include <algorithm>
 
 using namespace std::placeholders;
 
-static const uint8_t STATUS_UNDEFINED = 255;
-
-const char* MiLightClient::FIELD_ORDERINGS[] = {
-  // These are handled manually
-  // GroupStateFieldNames::STATE,
-  // GroupStateFieldNames::STATUS,
-  GroupStateFieldNames::HUE,
-  GroupStateFieldNames::SATURATION,
-  GroupStateFieldNames::KELVIN,
-  GroupStateFieldNames::TEMPERATURE,
-  GroupStateFieldNames::COLOR_TEMP,
-  GroupStateFieldNames::MODE,
-  GroupStateFieldNames::EFFECT,
-  GroupStateFieldNames::COLOR,
-  // Level/Brightness must be processed last because they're specific to a particular bulb mode.
-  // So make sure bulb mode is set before applying level/brightness.
-  GroupStateFieldNames::LEVEL,
-  GroupStateFieldNames::BRIGHTNESS,
-  GroupStateFieldNames::COMMAND,
-  GroupStateFieldNames::COMMANDS
-};
-
-const std::map<const char*, std::function<void(MiLightClient*, JsonVariant)>, MiLightClient::cmp_str> MiLightClient::FIELD_SETTERS = {
-  {
-    GroupStateFieldNames::STATUS,
-    [](MiLightClient* client, JsonVariant val) {
-      client->updateStatus(parseMilightStatus(val));
-    }
-  },
-  {GroupStateFieldNames::LEVEL, &MiLightClient::updateBrightness},
-  {
-    GroupStateFieldNames::BRIGHTNESS,
-    [](MiLightClient* client, uint16_t arg) {
-      client->updateBrightness(Units::rescale<uint16_t, uint16_t>(arg, 100, 255));
-    }
-  },
-  {GroupStateFieldNames::HUE, &MiLightClient::updateHue},
-  {GroupStateFieldNames::SATURATION, &MiLightClient::updateSaturation},
-  {GroupStateFieldNames::KELVIN, &MiLightClient::updateTemperature},
-  {GroupStateFieldNames::TEMPERATURE, &MiLightClient::updateTemperature},
-  {
-    GroupStateFieldNames::COLOR_TEMP,
-    [](MiLightClient* client, uint16_t arg) {
-      client->updateTemperature(Units::miredsToWhiteVal(arg, 100));
-    }
-  },
-  {GroupStateFieldNames::MODE, &MiLightClient::updateMode},
-  {GroupStateFieldNames::COLOR, &MiLightClient::updateColor},
-  {GroupStateFieldNames::EFFECT, &MiLightClient::handleEffect},
-  {GroupStateFieldNames::COMMAND, &MiLightClient::handleCommand},
-  {GroupStateFieldNames::COMMANDS, &MiLightClient::handleCommands}
-};
-
 MiLightClient::MiLightClient(
   RadioSwitchboard& radioSwitchboard,
   PacketSender& packetSender,
@@ -77,6 +25,8 @@ MiLightClient::MiLightClient(
   , packetSender(packetSender)
   , transitions(transitions)
   , repeatsOverride(0)
+  , suppressedPackets(0)
+  , batch(nullptr)
 { }
 
 void MiLightClient::setHeld(bool held) {
@@ -91,7 +41,7 @@ void MiLightClient::prepare(
   this->currentRemote = config;
 
   if (deviceId >= 0 && groupId >= 0) {
-    currentRemote->packetFormatter->prepare(deviceId, groupId);
+    currentRemote->packetFormatter->prepare(deviceId, groupId, &packetArena);
   }
 
   this->currentState = stateStore->get(deviceId, groupId, config->type);
@@ -280,19 +230,10 @@ void MiLightClient::toggleStatus() {
   flushPacket();
 }
 
-void MiLightClient::updateColor(JsonVariant json) {
-  ParsedColor color = ParsedColor::fromJson(json);
-
-  if (!color.success) {
-    Serial.println(F("Error parsing color field, unrecognized format"));
-    return;
-  }
-
-  // We consider an RGB color "white" if all color intensities are roughly the
-  // same value.  An unscientific value of 10 (~4%) is chosen.
-  if ( abs(color.r - color.g) < RGB_WHITE_THRESHOLD
-    && abs(color.g - color.b) < RGB_WHITE_THRESHOLD
-    && abs(color.r - color.b) < RGB_WHITE_THRESHOLD) {
+// We consider an RGB color "white" if all color intensities are roughly the
+// same value.  An unscientific value of 10 (~4%) is chosen.
+void MiLightClient::updateColor(const ParsedColor& color) {
+  if (color.isWhite()) {
       this->updateColorWhite();
   } else {
     this->updateHue(color.hue);
@@ -300,34 +241,163 @@ void MiLightClient::updateColor(JsonVariant json) {
   }
 }
 
+static bool isTransitionCommand(JsonVariant command) {
+  return command.is<JsonObject>()
+    && command[GroupStateFieldNames::COMMAND] == MiLightCommandNames::TRANSITION;
+}
+
 void MiLightClient::update(JsonObject request) {
+  update(StateUpdate::fromJson(request));
+  applyTransitionCommands(request);
+}
+
+void MiLightClient::update(JsonObject request, const std::vector<BulbId>& targets) {
+  update(StateUpdate::fromJson(request), targets);
+
+  bool hasTransitionCommands = isTransitionCommand(request[GroupStateFieldNames::COMMAND]);
+  JsonArray commands = request[GroupStateFieldNames::COMMANDS];
+
+  for (size_t i = 0; !hasTransitionCommands && i < commands.size(); ++i) {
+    hasTransitionCommands = isTransitionCommand(commands[i]);
+  }
+
+  if (!hasTransitionCommands) {
+    return;
+  }
+
+  // Only keep targets we can send to, so the group's first member is valid
+  std::vector<BulbId> members;
+  members.reserve(targets.size());
+
+  for (const BulbId& target : targets) {
+    if (MiLightRemoteConfig::fromType(target.deviceType) != NULL) {
+      members.push_back(target);
+    }
+  }
+
+  if (!members.empty()) {
+    applyTransitionCommands(request, members);
+  }
+}
+
+void MiLightClient::applyTransitionCommands(JsonObject request) {
+  // Transition commands carry JSON arguments and aren't part of a StateUpdate.  They
+  // only start on the next TransitionController::loop, so handling them after the rest
+  // of the update doesn't change the order packets are sent in.
+  if (isTransitionCommand(request[GroupStateFieldNames::COMMAND])) {
+    handleCommand(request[GroupStateFieldNames::COMMAND]);
+  }
+
+  JsonArray commands = request[GroupStateFieldNames::COMMANDS];
+  if (!commands.isNull()) {
+    for (JsonVariant command : commands) {
+      if (isTransitionCommand(command)) {
+        handleCommand(command);
+      }
+    }
+  }
+}
+
+void MiLightClient::applyTransitionCommands(JsonObject request, const std::vector<BulbId>& targets) {
+  // One group transition for all targets, rather than one each, keeps them in step
+  StaticJsonDocument<100> response;
+
+  if (isTransitionCommand(request[GroupStateFieldNames::COMMAND])) {
+    handleTransition(request[GroupStateFieldNames::COMMAND]["args"].as<JsonObject>(), targets, response);
+  }
+
+  JsonArray commands = request[GroupStateFieldNames::COMMANDS];
+  if (!commands.isNull()) {
+    for (JsonVariant command : commands) {
+      if (isTransitionCommand(command)) {
+        handleTransition(command["args"].as<JsonObject>(), targets, response);
+      }
+    }
+  }
+}
+
+static size_t radioConfigIndex(const BulbId& bulbId) {
+  const MiLightRemoteConfig* config = MiLightRemoteConfig::fromType(bulbId.deviceType);
+
+  if (config == NULL) {
+    return MiLightRadioConfig::NUM_CONFIGS;
+  }
+  return &config->radioConfig - MiLightRadioConfig::ALL_CONFIGS;
+}
+
+void MiLightClient::update(const StateUpdate& request, const std::vector<BulbId>& targets) {
+  std::vector<BulbId> ordered(targets);
+
+  // Stable so that bulbs sharing a radio config keep the order they were given in
+  std::stable_sort(
+    ordered.begin(),
+    ordered.end(),
+    [](const BulbId& a, const BulbId& b) { return radioConfigIndex(a) < radioConfigIndex(b); }
+  );
+
   if (this->updateBeginHandler) {
     this->updateBeginHandler();
   }
 
-  const JsonVariant status = this->extractStatus(request);
-  const uint8_t parsedStatus = this->parseStatus(status);
-  const JsonVariant jsonTransition = request[RequestKeys::TRANSITION];
-  float transition = 0;
+  // Build every target's packets before enqueueing any, unless the caller is already
+  // batching
+  PacketBatch targetBatch;
+  const bool ownsBatch = batch == nullptr;
 
-  if (!jsonTransition.isNull()) {
-    if (jsonTransition.is<float>()) {
-      transition = jsonTransition.as<float>();
-    } else if (jsonTransition.is<size_t>()) {
-      transition = jsonTransition.as<size_t>();
-    } else {
-      Serial.println(F("MiLightClient - WARN: unsupported transition type.  Must be float or int."));
+  if (ownsBatch) {
+    beginBatch(targetBatch);
+  }
+
+  for (const BulbId& target : ordered) {
+    const MiLightRemoteConfig* config = MiLightRemoteConfig::fromType(target.deviceType);
+
+    if (config == NULL) {
+      continue;
     }
+
+    prepare(config, target.deviceId, target.groupId);
+    applyUpdate(request);
   }
 
-  JsonVariant brightness = request[GroupStateFieldNames::BRIGHTNESS];
-  JsonVariant level = request[GroupStateFieldNames::LEVEL];
-  const bool isBrightnessDefined = !brightness.isNull() || !level.isNull();
+  if (ownsBatch) {
+    endBatch();
+    packetSender.enqueue(targetBatch);
+  }
+
+  if (this->updateEndHandler) {
+    this->updateEndHandler();
+  }
+}
+
+void MiLightClient::update(const StateUpdate& request) {
+  if (this->updateBeginHandler) {
+    this->updateBeginHandler();
+  }
+
+  applyUpdate(request);
+
+  if (this->updateEndHandler) {
+    this->updateEndHandler();
+  }
+}
+
+void MiLightClient::applyUpdate(const StateUpdate& request) {
+  const float transition = request.has(StateUpdate::TRANSITION) ? request.transition : 0;
+  const bool isBrightnessDefined = request.has(StateUpdate::BRIGHTNESS) || request.has(StateUpdate::LEVEL);
+  const bool hasStatus = request.has(StateUpdate::STATUS);
+
+  // Commands that wouldn't change the bulb's state are skipped if enabled and the state
+  // was confirmed recently.  Transitions and relative commands are always sent.
+  const bool suppress = transition == 0 && isStateFresh();
+  // Brightness is tracked per bulb mode, so it can't be skipped if the mode may change
+  bool sentModeChange = false;
 
   // Always turn on first
-  if (parsedStatus == ON) {
+  if (hasStatus && request.status == ON) {
     if (transition == 0) {
-      this->updateStatus(ON);
+      if (!isNoop(suppress && currentState->isSetState() && currentState->isOn())) {
+        this->updateStatus(ON);
+      }
     }
     // Don't do an "On" transition if the bulb is already on.  The reasons for this are:
     //   * Ambiguous what the behavior should be.  Should it ramp to full brightness?
@@ -342,58 +412,130 @@ void MiLightClient::update(JsonObject request) {
       // transitions only ramp up/down to the max/min.  Otherwise, just turn the bulb on
       // and let field transitions handle the rest.
       if (!isBrightnessDefined) {
-        handleTransition(GroupStateField::STATUS, status, transition, 0);
+        handleTransition(GroupStateField::STATUS, ON, transition, 0);
       } else {
         this->updateStatus(ON);
 
-        if (! brightness.isNull()) {
-          handleTransition(GroupStateField::BRIGHTNESS, brightness, transition, 0);
-        } else if (! level.isNull()) {
-          handleTransition(GroupStateField::LEVEL, level, transition, 0);
+        if (request.has(StateUpdate::BRIGHTNESS)) {
+          handleTransition(GroupStateField::BRIGHTNESS, request.brightness, transition, 0);
+        } else {
+          handleTransition(GroupStateField::LEVEL, request.level, transition, 0);
         }
       }
     }
   }
 
-  for (const char* fieldName : FIELD_ORDERINGS) {
-    if (request.containsKey(fieldName)) {
-      auto handler = FIELD_SETTERS.find(fieldName);
-      JsonVariant value = request[fieldName];
+  if (transition == 0) {
+    if (request.has(StateUpdate::HUE)
+      && !isNoop(suppress && isInBulbMode(BULB_MODE_COLOR) && isSameHue(request.hue))) {
+      this->updateHue(request.hue);
+      sentModeChange = true;
+    }
+    if (request.has(StateUpdate::SATURATION)
+      && !isNoop(suppress && isInBulbMode(BULB_MODE_COLOR) && isSameValue(GroupStateField::SATURATION, request.saturation))) {
+      this->updateSaturation(request.saturation);
+      sentModeChange = true;
+    }
+    if (request.has(StateUpdate::KELVIN)
+      && !isNoop(suppress && isInBulbMode(BULB_MODE_WHITE) && isSameValue(GroupStateField::KELVIN, request.kelvin))) {
+      this->updateTemperature(request.kelvin);
+      sentModeChange = true;
+    }
+    if (request.has(StateUpdate::COLOR_TEMP)) {
+      const uint8_t kelvin = Units::miredsToWhiteVal(request.colorTemp, 100);
 
-      if (handler != FIELD_SETTERS.end()) {
-        // No transition -- set field directly
-        if (transition == 0) {
-          handler->second(this, value);
-        } else {
-          GroupStateField field = GroupStateFieldHelpers::getFieldByName(fieldName);
-
-          if (   !GroupStateFieldHelpers::isBrightnessField(field)  // If field isn't brightness
-               || parsedStatus == STATUS_UNDEFINED                  // or if there was not a status field
-               || currentState->isOn()                              // or if bulb was already on
-          ) {
-            handleTransition(field, value, transition);
-          }
-        }
+      if (!isNoop(suppress && isInBulbMode(BULB_MODE_WHITE) && isSameValue(GroupStateField::KELVIN, kelvin))) {
+        this->updateTemperature(kelvin);
+        sentModeChange = true;
       }
     }
+  } else {
+    if (request.has(StateUpdate::HUE)) {
+      handleTransition(GroupStateField::HUE, request.hue, transition);
+    }
+    if (request.has(StateUpdate::SATURATION)) {
+      handleTransition(GroupStateField::SATURATION, request.saturation, transition);
+    }
+    if (request.has(StateUpdate::KELVIN)) {
+      handleTransition(GroupStateField::KELVIN, request.kelvin, transition);
+    }
+    if (request.has(StateUpdate::COLOR_TEMP)) {
+      handleTransition(GroupStateField::COLOR_TEMP, request.colorTemp, transition);
+    }
   }
 
-  // Raw packet command/args
-  if (request.containsKey("button_id") && request.containsKey("argument")) {
-    this->command(request["button_id"], request["argument"]);
+  // Modes and effects can't be transitioned
+  if (request.has(StateUpdate::MODE)
+    && !isNoop(suppress && isInBulbMode(BULB_MODE_SCENE) && isSameValue(GroupStateField::MODE, request.mode))) {
+    this->updateMode(request.mode);
+    sentModeChange = true;
+  }
+  if (request.has(StateUpdate::EFFECT)) {
+    const bool unchanged = request.effect == MiLightCommand::NIGHT_MODE
+      ? suppress && currentState->isNightMode()
+      : suppress && isInBulbMode(BULB_MODE_WHITE);
+
+    if (!isNoop(unchanged)) {
+      this->handleCommand(request.effect);
+      sentModeChange = true;
+    }
   }
 
-  // Always turn off last
-  if (parsedStatus == OFF) {
+  if (request.has(StateUpdate::COLOR)) {
     if (transition == 0) {
-      this->updateStatus(OFF);
+      if (!isNoop(suppress && isSameColor(request.color))) {
+        this->updateColor(request.color);
+        sentModeChange = true;
+      }
     } else {
-      handleTransition(GroupStateField::STATUS, status, transition);
+      handleColorTransition(request.color, transition);
     }
   }
 
-  if (this->updateEndHandler) {
-    this->updateEndHandler();
+  // Level/Brightness must be processed last because they're specific to a particular bulb mode.
+  // So make sure bulb mode is set before applying level/brightness.
+  if (transition == 0) {
+    const bool suppressBrightness = suppress && !sentModeChange && currentState->isSetBulbMode();
+
+    if (request.has(StateUpdate::LEVEL)
+      && !isNoop(suppressBrightness && isSameValue(GroupStateField::LEVEL, request.level))) {
+      this->updateBrightness(request.level);
+    }
+    if (request.has(StateUpdate::BRIGHTNESS)) {
+      const uint8_t level = Units::rescale<uint16_t, uint16_t>(request.brightness, 100, 255);
+
+      if (!isNoop(suppressBrightness && isSameValue(GroupStateField::LEVEL, level))) {
+        this->updateBrightness(level);
+      }
+    }
+  // Brightness transitions for a bulb being turned on were started above
+  } else if (!hasStatus || currentState->isOn()) {
+    if (request.has(StateUpdate::LEVEL)) {
+      handleTransition(GroupStateField::LEVEL, request.level, transition);
+    }
+    if (request.has(StateUpdate::BRIGHTNESS)) {
+      handleTransition(GroupStateField::BRIGHTNESS, request.brightness, transition);
+    }
+  }
+
+  for (size_t i = 0; i < request.numCommands; i++) {
+    this->handleCommand(request.commands[i]);
+  }
+
+  // Raw packet command/args
+  if (request.has(StateUpdate::RAW_COMMAND)) {
+    this->command(request.buttonId, request.argument);
+  }
+
+  // Always turn off last
+  if (hasStatus && request.status == OFF) {
+    if (transition == 0) {
+      if (!isNoop(suppress && currentState->isSetState() && currentState->getState() == OFF)) {
+        this->updateStatus(OFF);
+      }
+    } else {
+      handleTransition(GroupStateField::STATUS, OFF, transition);
+    }
   }
 }
 
@@ -406,54 +548,72 @@ void MiLightClient::handleCommands(JsonArray commands) {
 }
 
 void MiLightClient::handleCommand(JsonVariant command) {
-  String cmdName;
+  const char* cmdName = NULL;
   JsonObject args;
 
   if (command.is<JsonObject>()) {
     JsonObject cmdObj = command.as<JsonObject>();
-    cmdName = cmdObj[GroupStateFieldNames::COMMAND].as<const char*>();
+    cmdName = cmdObj[GroupStateFieldNames::COMMAND];
     args = cmdObj["args"];
   } else if (command.is<const char*>()) {
     cmdName = command.as<const char*>();
   }
 
-  if (cmdName == MiLightCommandNames::UNPAIR) {
-    this->unpair();
-  } else if (cmdName == MiLightCommandNames::PAIR) {
-    this->pair();
-  } else if (cmdName == MiLightCommandNames::SET_WHITE) {
-    this->updateColorWhite();
-  } else if (cmdName == MiLightCommandNames::NIGHT_MODE) {
-    this->enableNightMode();
-  } else if (cmdName == MiLightCommandNames::LEVEL_UP) {
-    this->increaseBrightness();
-  } else if (cmdName == MiLightCommandNames::LEVEL_DOWN) {
-    this->decreaseBrightness();
-  } else if (cmdName == "brightness_up") {
-    this->increaseBrightness();
-  } else if (cmdName == "brightness_down") {
-    this->decreaseBrightness();
-  } else if (cmdName == MiLightCommandNames::TEMPERATURE_UP) {
-    this->increaseTemperature();
-  } else if (cmdName == MiLightCommandNames::TEMPERATURE_DOWN) {
-    this->decreaseTemperature();
-  } else if (cmdName == MiLightCommandNames::NEXT_MODE) {
-    this->nextMode();
-  } else if (cmdName == MiLightCommandNames::PREVIOUS_MODE) {
-    this->previousMode();
-  } else if (cmdName == MiLightCommandNames::MODE_SPEED_DOWN) {
-    this->modeSpeedDown();
-  } else if (cmdName == MiLightCommandNames::MODE_SPEED_UP) {
-    this->modeSpeedUp();
-  } else if (cmdName == MiLightCommandNames::TOGGLE) {
-    this->toggleStatus();
-  } else if (cmdName == MiLightCommandNames::TRANSITION) {
+  MiLightCommand parsed;
+
+  if (StateUpdate::parseCommand(cmdName, parsed)) {
+    this->handleCommand(parsed);
+  } else if (cmdName != NULL && 0 == strcmp(cmdName, MiLightCommandNames::TRANSITION)) {
     StaticJsonDocument<100> fakedoc;
     this->handleTransition(args, fakedoc);
   }
 }
 
-void MiLightClient::handleTransition(GroupStateField field, JsonVariant value, float duration, int16_t startValue) {
+void MiLightClient::handleCommand(MiLightCommand command) {
+  switch (command) {
+    case MiLightCommand::UNPAIR:
+      this->unpair();
+      break;
+    case MiLightCommand::PAIR:
+      this->pair();
+      break;
+    case MiLightCommand::SET_WHITE:
+      this->updateColorWhite();
+      break;
+    case MiLightCommand::NIGHT_MODE:
+      this->enableNightMode();
+      break;
+    case MiLightCommand::LEVEL_UP:
+      this->increaseBrightness();
+      break;
+    case MiLightCommand::LEVEL_DOWN:
+      this->decreaseBrightness();
+      break;
+    case MiLightCommand::TEMPERATURE_UP:
+      this->increaseTemperature();
+      break;
+    case MiLightCommand::TEMPERATURE_DOWN:
+      this->decreaseTemperature();
+      break;
+    case MiLightCommand::NEXT_MODE:
+      this->nextMode();
+      break;
+    case MiLightCommand::PREVIOUS_MODE:
+      this->previousMode();
+      break;
+    case MiLightCommand::MODE_SPEED_DOWN:
+      this->modeSpeedDown();
+      break;
+    case MiLightCommand::MODE_SPEED_UP:
+      this->modeSpeedUp();
+      break;
+    case MiLightCommand::TOGGLE:
+      this->toggleStatus();
+      break;
+  }
+}
+
+void MiLightClient::handleTransition(GroupStateField field, uint16_t value, float duration, int16_t startValue) {
   BulbId bulbId = currentRemote->packetFormatter->currentBulbId();
   std::shared_ptr<Transition::Builder> transitionBuilder = nullptr;
 
@@ -467,18 +627,9 @@ void MiLightClient::handleTransition(GroupStateField field, JsonVariant value, f
     return;
   }
 
-  if (field == GroupStateField::COLOR) {
-    ParsedColor currentColor = currentState->getColor();
-    ParsedColor endColor = ParsedColor::fromJson(value);
-
-    transitionBuilder = transitions.buildColorTransition(
-      bulbId,
-      currentColor,
-      endColor
-    );
-  } else if (field == GroupStateField::STATUS || field == GroupStateField::STATE) {
+  if (field == GroupStateField::STATUS || field == GroupStateField::STATE) {
     uint8_t startLevel;
-    MiLightStatus status = parseMilightStatus(value);
+    MiLightStatus status = static_cast<MiLightStatus>(value);
 
     if (startValue == FETCH_VALUE_FROM_STATE || currentState->isOn()) {
       startLevel = currentState->getBrightness();
@@ -514,14 +665,114 @@ void MiLightClient::handleTransition(GroupStateField field, JsonVariant value, f
   transitions.addTransition(transitionBuilder->build());
 }
 
+void MiLightClient::applyTransitionStep(const BulbId& bulbId, GroupStateField field, uint16_t value) {
+  const MiLightRemoteConfig* config = MiLightRemoteConfig::fromType(bulbId.deviceType);
+
+  if (config == NULL) {
+    return;
+  }
+
+  prepare(config, bulbId.deviceId, bulbId.groupId);
+
+  switch (field) {
+    case GroupStateField::STATE:
+    case GroupStateField::STATUS:
+      this->updateStatus(static_cast<MiLightStatus>(value));
+      break;
+    case GroupStateField::LEVEL:
+      this->updateBrightness(value);
+      break;
+    case GroupStateField::BRIGHTNESS:
+      this->updateBrightness(Units::rescale<uint16_t, uint16_t>(value, 100, 255));
+      break;
+    case GroupStateField::HUE:
+      this->updateHue(value);
+      break;
+    case GroupStateField::SATURATION:
+      this->updateSaturation(value);
+      break;
+    case GroupStateField::KELVIN:
+      this->updateTemperature(value);
+      break;
+    case GroupStateField::COLOR_TEMP:
+      this->updateTemperature(Units::miredsToWhiteVal(value, 100));
+      break;
+    case GroupStateField::MODE:
+      this->updateMode(value);
+      break;
+    default:
+      Serial.printf_P(PSTR("MiLightClient - WARN: unsupported transition field: %s\n"), GroupStateFieldHelpers::getFieldName(field));
+      break;
+  }
+}
+
+void MiLightClient::handleColorTransition(const ParsedColor& endColor, float duration) {
+  if (currentState == nullptr || !currentState->isSetColor()) {
+    Serial.println(F("Error planning transition: current color could not be determined"));
+    return;
+  }
+
+  std::shared_ptr<Transition::Builder> transitionBuilder = transitions.buildColorTransition(
+    currentRemote->packetFormatter->currentBulbId(),
+    currentState->getColor(),
+    endColor
+  );
+
+  transitionBuilder->setDuration(duration);
+  transitions.addTransition(transitionBuilder->build());
+}
+
 bool MiLightClient::handleTransition(JsonObject args, JsonDocument& responseObj) {
+  JsonArray bulbs = args[FPSTR(TransitionParams::BULBS)];
+
+  if (bulbs.isNull()) {
+    return handleTransition(args, std::vector<BulbId>{currentRemote->packetFormatter->currentBulbId()}, responseObj);
+  }
+
+  std::vector<BulbId> members;
+  members.reserve(bulbs.size());
+
+  for (JsonObject bulb : bulbs) {
+    const char* deviceType = bulb[GroupStateFieldNames::DEVICE_TYPE];
+    const MiLightRemoteConfig* config = deviceType == NULL ? NULL : MiLightRemoteConfig::fromType(deviceType);
+
+    if (config == NULL) {
+      responseObj[F("error")] = F("Transition - unknown device type in bulbs");
+      return false;
+    }
+
+    members.push_back(BulbId(
+      parseInt<uint16_t>(bulb[GroupStateFieldNames::DEVICE_ID].as<String>()),
+      bulb[GroupStateFieldNames::GROUP_ID].as<uint8_t>(),
+      config->type
+    ));
+  }
+
+  if (members.empty()) {
+    responseObj[F("error")] = F("Transition - bulbs must not be empty");
+    return false;
+  }
+
+  return handleTransition(args, members, responseObj);
+}
+
+bool MiLightClient::handleTransition(JsonObject args, const std::vector<BulbId>& members, JsonDocument& responseObj) {
   if (! args.containsKey(FPSTR(TransitionParams::FIELD))
     || ! args.containsKey(FPSTR(TransitionParams::END_VALUE))) {
     responseObj[F("error")] = F("Ignoring transition missing required arguments");
     return false;
   }
 
-  const BulbId& bulbId = currentRemote->packetFormatter->currentBulbId();
+  const BulbId& bulbId = members.front();
+  const MiLightRemoteConfig* config = MiLightRemoteConfig::fromType(bulbId.deviceType);
+
+  if (config == NULL) {
+    responseObj[F("error")] = F("Transition - unknown device type");
+    return false;
+  }
+
+  // Start values that aren't given come from the first member
+  prepare(config, bulbId.deviceId, bulbId.groupId);
   const char* fieldName = args[FPSTR(TransitionParams::FIELD)];
   JsonVariant startValue = args[FPSTR(TransitionParams::START_VALUE)];
   JsonVariant endValue = args[FPSTR(TransitionParams::END_VALUE)];
@@ -581,7 +832,12 @@ bool MiLightClient::handleTransition(JsonObject args, JsonDocument& responseObj)
     );
   }
 
-  // Status is handled a little differently
+  if (transitionBuilder != nullptr && members.size() > 1) {
+    transitionBuilder = transitions.buildGroupTransition(members, transitionBuilder);
+  }
+
+  // Status is handled a little differently.  It also turns members on, so it does its
+  // own grouping.
   if (field == GroupStateField::STATUS || field == GroupStateField::STATE) {
     MiLightStatus toStatus = parseMilightStatus(endValue);
     uint8_t startLevel;
@@ -593,7 +849,7 @@ bool MiLightClient::handleTransition(JsonObject args, JsonDocument& responseObj)
       startLevel = 100;
     }
 
-    transitionBuilder = transitions.buildStatusTransition(bulbId, toStatus, startLevel);
+    transitionBuilder = transitions.buildStatusTransition(members, toStatus, startLevel);
   }
 
   if (transitionBuilder == nullptr) {
@@ -614,32 +870,56 @@ bool MiLightClient::handleTransition(JsonObject args, JsonDocument& responseObj)
   return true;
 }
 
-void MiLightClient::handleEffect(const String& effect) {
-  if (effect == MiLightCommandNames::NIGHT_MODE) {
-    this->enableNightMode();
-  } else if (effect == "white" || effect == "white_mode") {
-    this->updateColorWhite();
-  } else { // assume we're trying to set mode
-    this->updateMode(effect.toInt());
+bool MiLightClient::isStateFresh() const {
+  // Known state only catches up as packets finish sending, so it says nothing about
+  // what commands already queued or batched for the bulb are about to do
+  if (settings.noopSuppressionMaxAge == 0
+    || currentState == NULL
+    || currentState->getSyncAge() >= settings.noopSuppressionMaxAge) {
+    return false;
   }
-}
 
-JsonVariant MiLightClient::extractStatus(JsonObject object) {
-  JsonVariant status;
+  const BulbId bulbId = currentRemote->packetFormatter->currentBulbId();
 
-  if (object.containsKey(FPSTR(GroupStateFieldNames::STATUS))) {
-    return object[FPSTR(GroupStateFieldNames::STATUS)];
-  } else {
-    return object[FPSTR(GroupStateFieldNames::STATE)];
+  return !packetSender.isSendingTo(bulbId)
+    && (batch == nullptr || !batch->hasPacketsFor(bulbId));
+}
+
+bool MiLightClient::isNoop(bool unchanged) {
+  if (unchanged) {
+    ++suppressedPackets;
   }
+  return unchanged;
 }
 
-uint8_t MiLightClient::parseStatus(JsonVariant val) {
-  if (val.isNull()) {
-    return STATUS_UNDEFINED;
+bool MiLightClient::isInBulbMode(BulbMode mode) const {
+  return currentState->isSetBulbMode()
+    && !currentState->isNightMode()
+    && currentState->getBulbMode() == mode;
+}
+
+bool MiLightClient::isSameValue(GroupStateField field, uint16_t value) const {
+  return currentState->isSetField(field) && currentState->getParsedFieldValue(field) == value;
+}
+
+bool MiLightClient::isSameHue(uint16_t hue) const {
+  // Hue is stored with 8 bits of precision, so only compare to within a degree
+  return currentState->isSetHue()
+    && abs(static_cast<int>(currentState->getHue()) - static_cast<int>(hue)) <= 1;
+}
+
+bool MiLightClient::isSameColor(const ParsedColor& color) const {
+  if (color.isWhite()) {
+    return isInBulbMode(BULB_MODE_WHITE);
   }
 
-  return parseMilightStatus(val);
+  return isInBulbMode(BULB_MODE_COLOR)
+    && isSameHue(color.hue)
+    && isSameValue(GroupStateField::SATURATION, color.saturation);
+}
+
+size_t MiLightClient::getSuppressedPackets() const {
+  return suppressedPackets;
 }
 
 void MiLightClient::setRepeatsOverride(size_t repeats) {
@@ -650,11 +930,38 @@ void MiLightClient::clearRepeatsOverride() {
   this->repeatsOverride = PacketSender::DEFAULT_PACKET_SENDS_VALUE;
 }
 
+bool MiLightClient::isBackpressured() const {
+  return packetSender.isBackpressured();
+}
+
+void MiLightClient::beginBatch(PacketBatch& batch) {
+  this->batch = &batch;
+}
+
+void MiLightClient::endBatch() {
+  this->batch = nullptr;
+}
+
+void MiLightClient::beginTransitionSteps() {
+  beginBatch(transitionBatch);
+}
+
+void MiLightClient::endTransitionSteps() {
+  endBatch();
+  packetSender.enqueue(transitionBatch);
+}
+
 void MiLightClient::flushPacket() {
-  PacketStream& stream = currentRemote->packetFormatter->buildPackets();
+  PacketStream stream = currentRemote->packetFormatter->buildPackets();
 
-  while (stream.hasNext()) {
-    packetSender.enqueue(stream.next(), currentRemote, repeatsOverride);
+  if (batch != nullptr) {
+    // Send what's been built so far rather than hold more arenas
+    if (batch->isFull()) {
+      packetSender.enqueue(*batch);
+    }
+    batch->add(packetArena, currentRemote, repeatsOverride);
+  } else {
+    packetSender.enqueue(stream, currentRemote, repeatsOverride);
   }
 
   currentRemote->packetFormatter->reset();
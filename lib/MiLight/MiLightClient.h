@@ -7,8 +7,7 @@
 #include <GroupStateStore.h>
 #include <PacketSender.h>
 #include <TransitionController.h>
-#include <cstring>
-#include <map>
+#include <StateUpdate.h>
 #include <set>
 
 #ifndef _MILIGHTCLIENT_H
@@ -27,12 +26,10 @@ namespace TransitionParams {
   static const char END_VALUE[] PROGMEM = "end_value";
   static const char DURATION[] PROGMEM = "duration";
   static const char PERIOD[] PROGMEM = "period";
+  static const char BULBS[] PROGMEM = "bulbs";
 }
 
-// Used to determine RGB colros that are approximately white
-#define RGB_WHITE_THRESHOLD 10
-
-class MiLightClient {
+class MiLightClient : public TransitionSink {
 public:
   // Used to indicate that the start value for a transition should be fetched from current state
   static const int16_t FETCH_VALUE_FROM_STATE = -1;
@@ -78,7 +75,7 @@ public:
   void updateColorWhite();
   void updateColorRaw(const uint8_t color);
   void enableNightMode();
-  void updateColor(JsonVariant json);
+  void updateColor(const ParsedColor& color);
 
   // CCT methods
   void updateTemperature(const uint8_t colorTemperature);
@@ -89,12 +86,39 @@ public:
 
   void updateSaturation(const uint8_t saturation);
 
+  // Apply an update to the bulb selected with prepare().  Internal callers should build
+  // a StateUpdate; the JSON overload is for requests from the HTTP and MQTT APIs.
+  void update(const StateUpdate& request);
   void update(JsonObject object);
+
+  // Apply one update to several bulbs.  The request is parsed once and the begin/end
+  // handlers fire once for the whole batch.  Targets are visited grouped by radio
+  // config so that queued packets don't bounce the radio between configs.
+  void update(const StateUpdate& request, const std::vector<BulbId>& targets);
+  void update(JsonObject object, const std::vector<BulbId>& targets);
+  void handleCommand(MiLightCommand command);
   void handleCommand(JsonVariant command);
   void handleCommands(JsonArray commands);
+  // Transitions the current bulb, or every bulb listed in args.bulbs as a group
   bool handleTransition(JsonObject args, JsonDocument& responseObj);
-  void handleTransition(GroupStateField field, JsonVariant value, float duration, int16_t startValue = FETCH_VALUE_FROM_STATE);
-  void handleEffect(const String& effect);
+  // One transition stepping all members together.  Start values come from the first.
+  bool handleTransition(JsonObject args, const std::vector<BulbId>& members, JsonDocument& responseObj);
+  void handleTransition(GroupStateField field, uint16_t value, float duration, int16_t startValue = FETCH_VALUE_FROM_STATE);
+  void handleColorTransition(const ParsedColor& endColor, float duration);
+
+  // Sends a single transition step straight to the bulb's packet formatter, skipping
+  // StateUpdate and the update begin/end handlers.
+  virtual void applyTransitionStep(const BulbId& bulbId, GroupStateField field, uint16_t value) override;
+
+  // Steps from one pass are batched, so a group transition's members are enqueued
+  // together rather than one bulb at a time.
+  virtual void beginTransitionSteps() override;
+  virtual void endTransitionSteps() override;
+
+  // Until endBatch(), commands are built into the batch instead of being enqueued.
+  // The caller enqueues it with PacketSender::enqueue.
+  void beginBatch(PacketBatch& batch);
+  void endBatch();
 
   void onUpdateBegin(EventHandler handler);
   void onUpdateEnd(EventHandler handler);
@@ -110,18 +134,15 @@ public:
   // Clear the repeats override so that the default is used
   void clearRepeatsOverride();
 
-  uint8_t parseStatus(JsonVariant object);
-  JsonVariant extractStatus(JsonObject object);
+  // Number of commands skipped because the bulb was already in the requested state.
+  // See Settings::noopSuppressionMaxAge.
+  size_t getSuppressedPackets() const;
 
-protected:
-  struct cmp_str {
-    bool operator()(char const *a, char const *b) const {
-        return std::strcmp(a, b) < 0;
-    }
-  };
-  static const std::map<const char*, std::function<void(MiLightClient*, JsonVariant)>, cmp_str> FIELD_SETTERS;
-  static const char* FIELD_ORDERINGS[];
+  // Return true if the packet queue is too full to accept new commands.  Producers
+  // should defer or reject work until this returns false.
+  bool isBackpressured() const;
 
+protected:
   RadioSwitchboard& radioSwitchboard;
   std::vector<std::shared_ptr<MiLightRadio>> radios;
   std::shared_ptr<MiLightRadio> currentRadio;
@@ -139,7 +160,30 @@ protected:
   // If set, override the number of packet repeats used.
   size_t repeatsOverride;
 
+  size_t suppressedPackets;
+
+  // Packets for the current command are built here, then enqueued or added to the
+  // current batch by flushPacket
+  PacketArena packetArena;
+  PacketBatch* batch;
+  PacketBatch transitionBatch;
+
   void flushPacket();
+
+  // update() for the currently prepared bulb, without the begin/end handlers
+  void applyUpdate(const StateUpdate& request);
+  void applyTransitionCommands(JsonObject request);
+  void applyTransitionCommands(JsonObject request, const std::vector<BulbId>& targets);
+
+  // Helpers for skipping no-op commands.  All but isStateFresh assume currentState is
+  // set, so must only be evaluated once isStateFresh is known to be true.
+  bool isStateFresh() const;
+  // Counts a skipped command if unchanged is true, and returns it
+  bool isNoop(bool unchanged);
+  bool isInBulbMode(BulbMode mode) const;
+  bool isSameValue(GroupStateField field, uint16_t value) const;
+  bool isSameHue(uint16_t hue) const;
+  bool isSameColor(const ParsedColor& color) const;
 };
 
 #endif
@@ -1,5 +1,6 @@
 #include <MiLightRemoteConfig.h>
 #include <MiLightRemoteType.h>
+#include <V2RFEncoding.h>
 
 /**
  * IMPORTANT NOTE: These should be in the same order as MiLightRemoteType.
@@ -16,6 +17,21 @@ const MiLightRemoteConfig* MiLightRemoteConfig::ALL_REMOTES[] = {
 
 const size_t MiLightRemoteConfig::NUM_REMOTES = size(ALL_REMOTES);
 
+/**
+ * Remotes using the V2 encoding share a radio config, and can only be told apart
+ * by the protocol ID in the decoded packet.
+ */
+struct V2ProtocolEntry {
+  uint8_t protocolId;
+  const MiLightRemoteConfig* config;
+};
+
+static const V2ProtocolEntry V2_PROTOCOLS[] = {
+  { RGB_CCT_PROTOCOL_ID, &FUT092Config },
+  { FUT089_PROTOCOL_ID, &FUT089Config },
+  { FUT091_PROTOCOL_ID, &FUT091Config }
+};
+
 const MiLightRemoteConfig* MiLightRemoteConfig::fromType(const String& type) {
   return fromType(MiLightRemoteTypeHelpers::remoteTypeFromString(type));
 }
@@ -35,6 +51,18 @@ const MiLightRemoteConfig* MiLightRemoteConfig::fromReceivedPacket(
   const uint8_t* packet,
   const size_t len
 ) {
+  // Decode the protocol ID once and look it up, rather than having each V2
+  // formatter decode the packet in turn
+  if (len == V2_PACKET_LEN && &radioConfig == &V2_PROTOCOLS[0].config->radioConfig) {
+    const uint8_t protocolId = V2RFEncoding::decodeProtocolId(packet);
+
+    for (size_t i = 0; i < size(V2_PROTOCOLS); i++) {
+      if (V2_PROTOCOLS[i].protocolId == protocolId) {
+        return V2_PROTOCOLS[i].config;
+      }
+    }
+  }
+
   for (size_t i = 0; i < MiLightRemoteConfig::NUM_REMOTES; i++) {
     const MiLightRemoteConfig* config = MiLightRemoteConfig::ALL_REMOTES[i];
     if (&config->radioConfig == &radioConfig
@@ -0,0 +1,62 @@
+#include <PacketBatch.h>
+
+PacketStream PacketBuild::stream() {
+  return PacketStream(arena.buffer, arena.numPackets, remoteConfig->packetFormatter->getPacketLength());
+}
+
+void PacketBatch::add(const PacketArena& arena, const MiLightRemoteConfig* remoteConfig, size_t repeatsOverride) {
+  if (arena.numPackets == 0) {
+    return;
+  }
+
+  builds.push_back(PacketBuild{arena, remoteConfig, repeatsOverride});
+}
+
+void PacketBatch::clear() {
+  builds.clear();
+}
+
+bool PacketBatch::isEmpty() const {
+  return builds.empty();
+}
+
+bool PacketBatch::isFull() const {
+  return builds.size() >= MILIGHT_MAX_BATCHED_BUILDS;
+}
+
+size_t PacketBatch::numPackets() const {
+  size_t count = 0;
+
+  for (const PacketBuild& build : builds) {
+    count += build.arena.numPackets;
+  }
+
+  return count;
+}
+
+bool PacketBatch::hasPacketsFor(const BulbId& bulbId) const {
+  for (const PacketBuild& build : builds) {
+    uint16_t deviceId;
+    uint8_t sequenceNum;
+
+    if (build.remoteConfig->type != bulbId.deviceType) {
+      continue;
+    }
+
+    // Every packet in a build is for the same bulb
+    build.remoteConfig->packetFormatter->parsePacketHeader(build.arena.buffer, deviceId, sequenceNum);
+
+    if (deviceId == bulbId.deviceId) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::vector<PacketBuild>::iterator PacketBatch::begin() {
+  return builds.begin();
+}
+
+std::vector<PacketBuild>::iterator PacketBatch::end() {
+  return builds.end();
+}
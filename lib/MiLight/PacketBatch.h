@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include <MiLightRemoteConfig.h>
+#include <PacketFormatter.h>
+
+// Number of builds a batch holds before it has to be enqueued.  Each build takes a
+// full arena of RAM.
+#ifndef MILIGHT_MAX_BATCHED_BUILDS
+#define MILIGHT_MAX_BATCHED_BUILDS 8
+#endif
+
+// Packets for one command, kept in their own arena until they're enqueued
+struct PacketBuild {
+  PacketArena arena;
+  const MiLightRemoteConfig* remoteConfig;
+  size_t repeatsOverride;
+
+  PacketStream stream();
+};
+
+// Packets for several commands, built up front so that they can be enqueued together
+// with PacketSender::enqueue(PacketBatch&).
+class PacketBatch {
+public:
+  // Copy a finished build into the batch.  Empty builds are skipped.
+  void add(const PacketArena& arena, const MiLightRemoteConfig* remoteConfig, size_t repeatsOverride);
+  void clear();
+
+  bool isEmpty() const;
+  bool isFull() const;
+
+  // Total number of packets across all builds
+  size_t numPackets() const;
+
+  // Return true if a build addresses the bulb's remote type and device ID
+  bool hasPacketsFor(const BulbId& bulbId) const;
+
+  std::vector<PacketBuild>::iterator begin();
+  std::vector<PacketBuild>::iterator end();
+
+private:
+  std::vector<PacketBuild> builds;
+};
@@ -1,14 +1,28 @@
 #include <PacketFormatter.h>
+#include <algorithm>
 
-static uint8_t* PACKET_BUFFER = new uint8_t[PACKET_FORMATTER_BUFFER_SIZE];
+PacketArena::PacketArena()
+    : numPackets(0)
+{ }
+
+void PacketArena::clear() {
+  numPackets = 0;
+}
 
 PacketStream::PacketStream()
-    : packetStream(PACKET_BUFFER),
+    : packetStream(NULL),
       numPackets(0),
       packetLength(0),
       currentPacket(0)
 { }
 
+PacketStream::PacketStream(uint8_t* packetStream, size_t numPackets, size_t packetLength)
+    : packetStream(packetStream),
+      numPackets(numPackets),
+      packetLength(packetLength),
+      currentPacket(0)
+{ }
+
 bool PacketStream::hasNext() {
   return currentPacket < numPackets;
 }
@@ -22,11 +36,15 @@ uint8_t* PacketStream::next() {
 PacketFormatter::PacketFormatter(const MiLightRemoteType deviceType, const size_t packetLength, const size_t maxPackets)
   : deviceType(deviceType),
     packetLength(packetLength),
-    numPackets(0),
-    currentPacket(NULL),
-    held(false)
+    held(false),
+    arena(NULL),
+    nextTemplate(0),
+    templateHits(0),
+    templateMisses(0)
 {
-  packetStream.packetLength = packetLength;
+  for (size_t i = 0; i < PACKET_FORMATTER_TEMPLATE_CACHE_SIZE; i++) {
+    templates[i].valid = false;
+  }
 }
 
 void PacketFormatter::initialize(GroupStateStore* stateStore, const Settings* settings) {
@@ -84,6 +102,16 @@ BulbId PacketFormatter::parsePacket(const uint8_t *packet, JsonObject result) {
   return DEFAULT_BULB_ID;
 }
 
+void PacketFormatter::parsePacketHeader(const uint8_t* packet, uint16_t& deviceId, uint8_t& sequenceNum) {
+  deviceId = (packet[1] << 8) | packet[2];
+  sequenceNum = packet[packetLength - 1];
+}
+
+size_t PacketFormatter::packetKey(const uint8_t* packet, uint8_t* key) {
+  memcpy(key, packet, packetLength);
+  return packetLength;
+}
+
 void PacketFormatter::pair() {
   for (size_t i = 0; i < 5; i++) {
     updateStatus(ON);
@@ -94,24 +122,32 @@ void PacketFormatter::unpair() {
   pair();
 }
 
-PacketStream& PacketFormatter::buildPackets() {
-  if (numPackets > 0) {
-    finalizePacket(currentPacket);
+PacketStream PacketFormatter::buildPackets() {
+  if (arena == NULL) {
+    return PacketStream();
   }
 
-  packetStream.numPackets = numPackets;
-  packetStream.currentPacket = 0;
+  if (arena->numPackets > 0) {
+    finalizePacket(currentPacket());
+  }
 
-  return packetStream;
+  return PacketStream(arena->buffer, arena->numPackets, packetLength);
 }
 
 void PacketFormatter::valueByStepFunction(StepFunction increase, StepFunction decrease, uint8_t numSteps, uint8_t targetValue, int8_t knownValue) {
   StepFunction fn;
   size_t numCommands = 0;
 
-  // If current value is not known, drive down to minimum value.  Then we can assume that we
-  // know the state (it'll be 0).
-  if (knownValue == -1) {
+  // If current value is not known, drive to the extreme nearest the target.  Then we can
+  // assume that we know the state.
+  if (knownValue == -1 && targetValue > numSteps / 2) {
+    for (size_t i = 0; i < numSteps; i++) {
+      (this->*increase)();
+    }
+
+    fn = decrease;
+    numCommands = numSteps - std::min(targetValue, numSteps);
+  } else if (knownValue == -1) {
     for (size_t i = 0; i < numSteps; i++) {
       (this->*decrease)();
     }
@@ -134,32 +170,88 @@ void PacketFormatter::valueByStepFunction(StepFunction increase, StepFunction de
   }
 }
 
-void PacketFormatter::prepare(uint16_t deviceId, uint8_t groupId) {
+void PacketFormatter::prepare(uint16_t deviceId, uint8_t groupId, PacketArena* arena) {
   this->deviceId = deviceId;
   this->groupId = groupId;
+  this->arena = arena;
   reset();
 }
 
 void PacketFormatter::reset() {
-  this->numPackets = 0;
-  this->currentPacket = PACKET_BUFFER;
+  if (arena != NULL) {
+    arena->clear();
+  }
   this->held = false;
 }
 
+uint8_t* PacketFormatter::currentPacket() {
+  if (arena == NULL) {
+    return scratchPacket;
+  } else if (arena->numPackets == 0) {
+    return arena->buffer;
+  } else {
+    return arena->buffer + ((arena->numPackets - 1) * packetLength);
+  }
+}
+
 void PacketFormatter::pushPacket() {
-  if (numPackets > 0) {
-    finalizePacket(currentPacket);
+  if (arena == NULL) {
+    Serial.println(F("ERROR: no packet arena to build into!  THIS IS A BUG!"));
+    return;
+  }
+
+  if (arena->numPackets > 0) {
+    finalizePacket(currentPacket());
   }
 
   // Make sure there's enough buffer to add another packet.
-  if ((currentPacket + packetLength) >= PACKET_BUFFER + PACKET_FORMATTER_BUFFER_SIZE) {
+  if ((arena->numPackets + 1) * packetLength > PACKET_FORMATTER_BUFFER_SIZE) {
     Serial.println(F("ERROR: packet buffer full!  Cannot buffer a new packet.  THIS IS A BUG!"));
     return;
   }
 
-  currentPacket = PACKET_BUFFER + (numPackets * packetLength);
-  numPackets++;
-  initializePacket(currentPacket);
+  arena->numPackets++;
+  initializeFromTemplate(currentPacket());
+}
+
+void PacketFormatter::initializeFromTemplate(uint8_t* packet) {
+  for (size_t i = 0; i < PACKET_FORMATTER_TEMPLATE_CACHE_SIZE; i++) {
+    const PacketTemplate& cached = templates[i];
+
+    if (cached.valid && cached.deviceId == deviceId && cached.groupId == groupId) {
+      memcpy(packet, cached.packet, packetLength);
+      packet[getSequenceNumIndex()] = sequenceNum++;
+      templateHits++;
+      return;
+    }
+  }
+
+  initializePacket(packet);
+  templateMisses++;
+
+  if (packetLength > MILIGHT_MAX_PACKET_LENGTH) {
+    return;
+  }
+
+  PacketTemplate& cached = templates[nextTemplate];
+  nextTemplate = (nextTemplate + 1) % PACKET_FORMATTER_TEMPLATE_CACHE_SIZE;
+
+  cached.deviceId = deviceId;
+  cached.groupId = groupId;
+  cached.valid = true;
+  memcpy(cached.packet, packet, packetLength);
+}
+
+size_t PacketFormatter::getSequenceNumIndex() const {
+  return packetLength - 1;
+}
+
+size_t PacketFormatter::getTemplateHits() const {
+  return templateHits;
+}
+
+size_t PacketFormatter::getTemplateMisses() const {
+  return templateMisses;
 }
 
 void PacketFormatter::format(uint8_t const* packet, char* buffer) {
@@ -6,6 +6,7 @@
 #include <GroupState.h>
 #include <GroupStateStore.h>
 #include <Settings.h>
+#include <MiLightRadioConfig.h>
 
 #ifndef _PACKET_FORMATTER_H
 #define _PACKET_FORMATTER_H
@@ -15,8 +16,27 @@
 //   (10 * 7) + (10 * 7) = 140
 #define PACKET_FORMATTER_BUFFER_SIZE 140
 
+// Number of (device ID, group ID) pairs per remote type to keep a prebuilt packet
+// header for.  Transitions and bursts of commands tend to hit the same few bulbs.
+#ifndef PACKET_FORMATTER_TEMPLATE_CACHE_SIZE
+#define PACKET_FORMATTER_TEMPLATE_CACHE_SIZE 4
+#endif
+
+// Backing storage and progress for the packets of one build.  The formatter writes
+// into the arena passed to prepare(), so a build's packets stay valid while other
+// builds use other arenas.  Holds no pointers into itself, so it can be copied.
+struct PacketArena {
+  PacketArena();
+
+  void clear();
+
+  uint8_t buffer[PACKET_FORMATTER_BUFFER_SIZE];
+  size_t numPackets;
+};
+
 struct PacketStream {
   PacketStream();
+  PacketStream(uint8_t* packetStream, size_t numPackets, size_t packetLength);
 
   uint8_t* next();
   bool hasNext();
@@ -79,42 +99,90 @@ public:
 
   virtual void reset();
 
-  virtual PacketStream& buildPackets();
-  virtual void prepare(uint16_t deviceId, uint8_t groupId);
+  // Finalize the packets built since prepare().  The returned stream points into the
+  // arena given to prepare(), and is valid until that arena is reset.
+  virtual PacketStream buildPackets();
+
+  // Start building packets for a bulb into the given arena.  Without an arena the
+  // formatter can only be used to parse packets.
+  virtual void prepare(uint16_t deviceId, uint8_t groupId, PacketArena* arena = NULL);
   virtual void format(uint8_t const* packet, char* buffer);
 
   virtual BulbId parsePacket(const uint8_t* packet, JsonObject result);
   virtual BulbId currentBulbId() const;
 
+  // Cheaply extract the device ID and sequence number from a raw packet without
+  // parsing its command.  Default implementation handles the V1 layout, where the
+  // device ID is in bytes 1-2 and the sequence number is the last byte.
+  virtual void parsePacketHeader(const uint8_t* packet, uint16_t& deviceId, uint8_t& sequenceNum);
+
+  // Write the decoded contents that identify a packet (device ID, group, command,
+  // argument and sequence number) to key, which must hold at least packetLength
+  // bytes.  Repeats of the same button press have identical keys.  Returns the
+  // number of bytes written.
+  virtual size_t packetKey(const uint8_t* packet, uint8_t* key);
+
   static void formatV1Packet(uint8_t const* packet, char* buffer);
 
   size_t getPacketLength() const;
 
+  // Number of packets initialized from a cached header, and ones that had to be
+  // built from scratch
+  size_t getTemplateHits() const;
+  size_t getTemplateMisses() const;
+
 protected:
   const MiLightRemoteType deviceType;
   size_t packetLength;
-  size_t numPackets;
-  uint8_t* currentPacket;
   bool held;
   uint16_t deviceId;
   uint8_t groupId;
   uint8_t sequenceNum;
-  PacketStream packetStream;
+  PacketArena* arena;
   GroupStateStore* stateStore = NULL;
   const Settings* settings = NULL;
 
   void pushPacket();
 
+  // The packet being built by the current command
+  uint8_t* currentPacket();
+
+  // Position of the sequence number in an unencoded packet.  Default is the last
+  // byte, as in the V1 layout.
+  virtual size_t getSequenceNumIndex() const;
+
   // Get field into a desired state using only increment/decrement commands.  Do this by:
-  //   1. Driving it down to its minimum value
-  //   2. Applying the appropriate number of increase commands to get it to the desired
-  //      value.
+  //   1. Driving it to whichever extreme is closer to the desired value
+  //   2. Applying the appropriate number of commands in the other direction to get it to
+  //      the desired value.
   // If the current state is already known, take that into account and apply the exact
   // number of rpeeats for the appropriate command.
   void valueByStepFunction(StepFunction increase, StepFunction decrease, uint8_t numSteps, uint8_t targetValue, int8_t knownValue = -1);
 
+  // Must only depend on deviceId, groupId and sequenceNum, because its output is
+  // cached and reused for later packets to the same bulb.
   virtual void initializePacket(uint8_t* packetStart) = 0;
   virtual void finalizePacket(uint8_t* packet);
+
+private:
+  // Output of initializePacket for a bulb, with the sequence number patched in on
+  // reuse
+  struct PacketTemplate {
+    uint16_t deviceId;
+    uint8_t groupId;
+    bool valid;
+    uint8_t packet[MILIGHT_MAX_PACKET_LENGTH];
+  };
+
+  // Commands issued without an arena are written here and discarded
+  uint8_t scratchPacket[MILIGHT_MAX_PACKET_LENGTH];
+
+  PacketTemplate templates[PACKET_FORMATTER_TEMPLATE_CACHE_SIZE];
+  size_t nextTemplate;
+  size_t templateHits;
+  size_t templateMisses;
+
+  void initializeFromTemplate(uint8_t* packet);
 };
 
 #endif
@@ -1,14 +1,27 @@
 #include <PacketQueue.h>
 
+bool QueuedPacket::isFor(const BulbId& bulbId) const {
+  uint16_t deviceId;
+  uint8_t sequenceNum;
+
+  if (remoteConfig->type != bulbId.deviceType) {
+    return false;
+  }
+
+  remoteConfig->packetFormatter->parsePacketHeader(packet, deviceId, sequenceNum);
+  return deviceId == bulbId.deviceId;
+}
+
 PacketQueue::PacketQueue()
   : droppedPackets(0)
 { }
 
-void PacketQueue::push(const uint8_t* packet, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride) {
+void PacketQueue::push(const uint8_t* packet, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride, const uint32_t completionToken) {
   std::shared_ptr<QueuedPacket> qp = checkoutPacket();
   memcpy(qp->packet, packet, remoteConfig->packetFormatter->getPacketLength());
   qp->remoteConfig = remoteConfig;
   qp->repeatsOverride = repeatsOverride;
+  qp->completionToken = completionToken;
 }
 
 bool PacketQueue::isEmpty() const {
@@ -19,6 +32,15 @@ size_t PacketQueue::getDroppedPacketCount() const {
   return droppedPackets;
 }
 
+bool PacketQueue::hasPacketsFor(const BulbId& bulbId) {
+  for (ListNode<std::shared_ptr<QueuedPacket>>* node = queue.getHead(); node != NULL; node = node->next) {
+    if (node->data->isFor(bulbId)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 std::shared_ptr<QueuedPacket> PacketQueue::pop() {
   return queue.shift();
 }
@@ -14,18 +14,24 @@ struct QueuedPacket {
   uint8_t packet[MILIGHT_MAX_PACKET_LENGTH];
   const MiLightRemoteConfig* remoteConfig;
   size_t repeatsOverride;
+  uint32_t completionToken;
+
+  bool isFor(const BulbId& bulbId) const;
 };
 
 class PacketQueue {
 public:
   PacketQueue();
 
-  void push(const uint8_t* packet, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride);
+  void push(const uint8_t* packet, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride, const uint32_t completionToken);
   std::shared_ptr<QueuedPacket> pop();
   bool isEmpty() const;
   size_t size() const;
   size_t getDroppedPacketCount() const;
 
+  // Return true if a queued packet addresses the bulb's remote type and device ID
+  bool hasPacketsFor(const BulbId& bulbId);
+
 private:
   size_t droppedPackets;
 
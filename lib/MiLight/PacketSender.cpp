@@ -10,6 +10,13 @@ PacketSender::PacketSender(
   , currentPacket(nullptr)
   , packetRepeatsRemaining(0)
   , packetSentHandler(packetSentHandler)
+  , lastEnqueued(0)
+  , lastCompleted(0)
+  , currentPacketStart(0)
+  , packetServiceTime(0)
+  , backpressured(false)
+  , numBackpressureEvents(0)
+  , numReducedRepeatSends(0)
   , lastSend(0)
   , currentResendCount(settings.packetRepeats)
   , throttleMultiplier(
@@ -19,15 +26,52 @@ PacketSender::PacketSender(
     )
 { }
 
-void PacketSender::enqueue(uint8_t* packet, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride) {
+PacketSender::CompletionToken PacketSender::enqueue(uint8_t* packet, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride) {
 #ifdef DEBUG_PRINTF
   Serial.println("Enqueuing packet");
 #endif
-  size_t repeats = repeatsOverride == DEFAULT_PACKET_SENDS_VALUE
-    ? this->currentResendCount
-    : repeatsOverride;
+  size_t repeats = repeatsOverride;
 
-  queue.push(packet, remoteConfig, repeats);
+  if (repeats == DEFAULT_PACKET_SENDS_VALUE) {
+    repeats = this->currentResendCount;
+
+    if (settings.adaptivePacketRepeats) {
+      uint16_t deviceId;
+      uint8_t sequenceNum;
+
+      remoteConfig->packetFormatter->parsePacketHeader(packet, deviceId, sequenceNum);
+      const size_t learnedRepeats = repeatLearner.repeatsFor(deviceId, repeats, settings.packetRepeatMinimum);
+
+      if (learnedRepeats < repeats) {
+        numReducedRepeatSends++;
+      }
+      repeats = learnedRepeats;
+    }
+  }
+
+  waitForRoom(1);
+  queue.push(packet, remoteConfig, repeats, ++lastEnqueued);
+  updateBackpressure();
+
+  return lastEnqueued;
+}
+
+PacketSender::CompletionToken PacketSender::enqueue(PacketStream& stream, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride) {
+  while (stream.hasNext()) {
+    enqueue(stream.next(), remoteConfig, repeatsOverride);
+  }
+
+  return lastEnqueued;
+}
+
+PacketSender::CompletionToken PacketSender::enqueue(PacketBatch& batch) {
+  for (PacketBuild& build : batch) {
+    PacketStream stream = build.stream();
+    enqueue(stream, build.remoteConfig, build.repeatsOverride);
+  }
+
+  batch.clear();
+  return lastEnqueued;
 }
 
 void PacketSender::loop() {
@@ -42,15 +86,43 @@ void PacketSender::loop() {
   }
 }
 
-bool PacketSender::isSending() {
+void PacketSender::recordReceivedPacket(const uint8_t* packet, const MiLightRemoteConfig& remoteConfig) {
+  if (settings.adaptivePacketRepeats) {
+    uint16_t deviceId;
+    uint8_t sequenceNum;
+
+    remoteConfig.packetFormatter->parsePacketHeader(packet, deviceId, sequenceNum);
+    repeatLearner.recordReceivedPacket(deviceId, sequenceNum);
+  }
+}
+
+bool PacketSender::isSending() const {
   return packetRepeatsRemaining > 0 || !queue.isEmpty();
 }
 
+bool PacketSender::isSendingTo(const BulbId& bulbId) {
+  if (packetRepeatsRemaining > 0 && currentPacket->isFor(bulbId)) {
+    return true;
+  }
+  return queue.hasPacketsFor(bulbId);
+}
+
+PacketSender::CompletionToken PacketSender::lastEnqueuedToken() const {
+  return lastEnqueued;
+}
+
+bool PacketSender::isComplete(CompletionToken token) const {
+  // Signed difference handles the counter wrapping around
+  return static_cast<int32_t>(lastCompleted - token) >= 0;
+}
+
 void PacketSender::nextPacket() {
 #ifdef DEBUG_PRINTF
   Serial.printf("Switching to next packet, %d packets in queue\n", queue.size());
 #endif
   currentPacket = queue.pop();
+  currentPacketStart = micros();
+  updateBackpressure();
 
   if (currentPacket->repeatsOverride > 0) {
     packetRepeatsRemaining = currentPacket->repeatsOverride;
@@ -70,9 +142,21 @@ void PacketSender::handleCurrentPacket() {
   sendRepeats(numToSend);
   packetRepeatsRemaining -= numToSend;
 
-  // If we're done sending this packet, fire the sent packet callback
-  if (packetRepeatsRemaining == 0 && packetSentHandler != nullptr) {
-    packetSentHandler(currentPacket->packet, *currentPacket->remoteConfig);
+  if (packetRepeatsRemaining == 0) {
+    lastCompleted = currentPacket->completionToken;
+
+    // Average over roughly the last 8 packets
+    const uint32_t serviceTime = micros() - currentPacketStart;
+    if (packetServiceTime == 0) {
+      packetServiceTime = serviceTime;
+    } else {
+      packetServiceTime = packetServiceTime - packetServiceTime / 8 + serviceTime / 8;
+    }
+
+    // If we're done sending this packet, fire the sent packet callback
+    if (packetSentHandler != nullptr) {
+      packetSentHandler(currentPacket->packet, *currentPacket->remoteConfig);
+    }
   }
 }
 
@@ -80,10 +164,52 @@ size_t PacketSender::queueLength() const {
   return queue.size();
 }
 
+bool PacketSender::hasRoomFor(size_t numPackets) const {
+  return queue.size() + numPackets <= MILIGHT_MAX_QUEUED_PACKETS;
+}
+
+void PacketSender::waitForRoom(size_t numPackets) {
+  while (!hasRoomFor(numPackets)) {
+    loop();
+    yield();
+  }
+}
+
 size_t PacketSender::droppedPackets() const {
   return queue.getDroppedPacketCount();
 }
 
+bool PacketSender::isBackpressured() const {
+  return backpressured;
+}
+
+void PacketSender::updateBackpressure() {
+  size_t length = queue.size();
+
+  if (backpressured && length <= MILIGHT_QUEUE_LOW_WATERMARK) {
+    backpressured = false;
+  } else if (!backpressured && length >= MILIGHT_QUEUE_HIGH_WATERMARK) {
+    backpressured = true;
+    numBackpressureEvents++;
+  }
+}
+
+size_t PacketSender::backpressureEvents() const {
+  return numBackpressureEvents;
+}
+
+size_t PacketSender::reducedRepeatSends() const {
+  return numReducedRepeatSends;
+}
+
+uint32_t PacketSender::getPacketServiceTime() const {
+  return packetServiceTime;
+}
+
+const RepeatLearner& PacketSender::getRepeatLearner() const {
+  return repeatLearner;
+}
+
 void PacketSender::sendRepeats(size_t num) {
   size_t len = currentPacket->remoteConfig->packetFormatter->getPacketLength();
 
@@ -2,35 +2,93 @@
 
 #include <MiLightRadioFactory.h>
 #include <MiLightRemoteConfig.h>
+#include <PacketBatch.h>
 #include <PacketQueue.h>
 #include <RadioSwitchboard.h>
+#include <RepeatLearner.h>
+
+// Producers are asked to back off once the queue reaches the high watermark, and
+// may resume once it has drained to the low watermark.  One command can expand to
+// more packets than the headroom above the watermark, so enqueue() also waits for a
+// free slot rather than overwrite a queued packet.
+#ifndef MILIGHT_QUEUE_HIGH_WATERMARK
+#define MILIGHT_QUEUE_HIGH_WATERMARK ((MILIGHT_MAX_QUEUED_PACKETS * 3) / 4)
+#endif
+
+#ifndef MILIGHT_QUEUE_LOW_WATERMARK
+#define MILIGHT_QUEUE_LOW_WATERMARK (MILIGHT_MAX_QUEUED_PACKETS / 4)
+#endif
 
 class PacketSender {
 public:
   typedef std::function<void(uint8_t* packet, const MiLightRemoteConfig& config)> PacketSentHandler;
   static const size_t DEFAULT_PACKET_SENDS_VALUE = 0;
 
+  // Identifies an enqueued packet.  Packets are sent in order, so a token is
+  // complete once every packet enqueued up to and including it has been sent.
+  typedef uint32_t CompletionToken;
+
   PacketSender(
     RadioSwitchboard& radioSwitchboard,
     Settings& settings,
     PacketSentHandler packetSentHandler
   );
 
-  void enqueue(uint8_t* packet, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride = 0);
+  // Blocks, sending queued packets, until there's room for the packet
+  CompletionToken enqueue(uint8_t* packet, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride = 0);
+  CompletionToken enqueue(PacketStream& stream, const MiLightRemoteConfig* remoteConfig, const size_t repeatsOverride = 0);
+  // Enqueue every build in the batch, in order, and clear it
+  CompletionToken enqueue(PacketBatch& batch);
   void loop();
 
+  // Feed a packet received from another transmitter into adaptive repeat learning
+  void recordReceivedPacket(const uint8_t* packet, const MiLightRemoteConfig& remoteConfig);
+
   // Return true if there are queued packets
-  bool isSending();
+  bool isSending() const;
+
+  // Return true if queued packets address the bulb's device.  Matches every group,
+  // since commands to group 0 change them all.
+  bool isSendingTo(const BulbId& bulbId);
+
+  // Token for the most recently enqueued packet
+  CompletionToken lastEnqueuedToken() const;
+
+  // Return true if the packet identified by the token (and everything enqueued
+  // before it) has finished sending or was dropped.
+  bool isComplete(CompletionToken token) const;
 
   // Return the number of queued packets
   size_t queueLength() const;
+
+  // Return true if numPackets can be enqueued without waiting
+  bool hasRoomFor(size_t numPackets) const;
   size_t droppedPackets() const;
 
+  // Return true if producers should stop enqueueing new commands.  Becomes true
+  // when the queue reaches the high watermark and stays true until it drains to
+  // the low watermark.
+  bool isBackpressured() const;
+
+  // Number of times the queue has crossed the high watermark
+  size_t backpressureEvents() const;
+
+  // Number of packets sent with fewer repeats because of learned link quality
+  size_t reducedRepeatSends() const;
+
+  // Moving average of how long (us) a packet takes from starting to send until all of
+  // its repeats are done, including time spent in the rest of the main loop.  This is
+  // the queue's real throughput.  Zero until a packet has been sent.
+  uint32_t getPacketServiceTime() const;
+
+  const RepeatLearner& getRepeatLearner() const;
+
 private:
   RadioSwitchboard& radioSwitchboard;
   Settings& settings;
   GroupStateStore* stateStore;
   PacketQueue queue;
+  RepeatLearner repeatLearner;
 
   // The current packet we're sending and the number of repeats left
   std::shared_ptr<QueuedPacket> currentPacket;
@@ -49,6 +107,26 @@ private:
   // Send repeats of the current packet N times
   void sendRepeats(size_t num);
 
+  // Send queued packets until there's room for numPackets more
+  void waitForRoom(size_t numPackets);
+
+  // Apply the watermarks to the current queue length.  Called whenever it changes.
+  void updateBackpressure();
+
+  // Tokens for the last enqueued packet and the last packet to finish sending
+  CompletionToken lastEnqueued;
+  CompletionToken lastCompleted;
+
+  // See getPacketServiceTime()
+  unsigned long currentPacketStart;
+  uint32_t packetServiceTime;
+
+  // Backpressure state, see isBackpressured()
+  bool backpressured;
+  size_t numBackpressureEvents;
+
+  size_t numReducedRepeatSends;
+
   // Used to track auto repeat limiting
   unsigned long lastSend;
   uint8_t currentResendCount;
@@ -1,19 +1,64 @@
 #include <RadioSwitchboard.h>
+#include <algorithm>
 
 RadioSwitchboard::RadioSwitchboard(
   std::shared_ptr<MiLightRadioFactory> radioFactory,
   GroupStateStore* stateStore,
-  Settings& settings
-) {
+  Settings& settings,
+  std::shared_ptr<MiLightRadioFactory> listenRadioFactory
+) : recentlySentIx(0)
+  , lastIrqPoll(0)
+  , irqMaxLatency(0)
+  , pollAfterSend(false)
+{
   for (size_t i = 0; i < MiLightRadioConfig::NUM_CONFIGS; i++) {
     std::shared_ptr<MiLightRadio> radio = radioFactory->create(MiLightRadioConfig::ALL_CONFIGS[i]);
     radio->begin();
     radios.push_back(radio);
   }
 
+  if (listenRadioFactory != nullptr) {
+    for (size_t i = 0; i < MiLightRadioConfig::NUM_CONFIGS; i++) {
+      std::shared_ptr<MiLightRadio> radio = listenRadioFactory->create(MiLightRadioConfig::ALL_CONFIGS[i]);
+      radio->begin();
+      listenRadios.push_back(radio);
+    }
+  }
+
+  for (size_t i = 0; i < MILIGHT_RECENTLY_SENT_PACKETS; i++) {
+    recentlySent[i].length = 0;
+    recentlySent[i].sentAt = 0;
+  }
+
   for (size_t i = 0; i < MiLightRemoteConfig::NUM_REMOTES; i++) {
     MiLightRemoteConfig::ALL_REMOTES[i]->packetFormatter->initialize(stateStore, &settings);
   }
+
+  if (settings.radioIrqPin >= 0) {
+    RadioInterfaceType receiverType = listenRadioFactory != nullptr
+      ? settings.listenRadioInterfaceType
+      : settings.radioInterfaceType;
+
+    // nRF24 IRQ is active low, LT8900 PKT_FLAG is active high
+    irq.reset(new RadioIrq(settings.radioIrqPin, receiverType == LT8900 ? RISING : FALLING));
+  }
+
+  // Favor listening on the radio configs used by remotes we have aliases for
+  for (const auto& alias : settings.groupIdAliases) {
+    const MiLightRemoteType type = alias.second.bulbId.deviceType;
+
+    if (type == REMOTE_TYPE_UNKNOWN || type >= MiLightRemoteConfig::NUM_REMOTES) {
+      continue;
+    }
+
+    const MiLightRadioConfig* radioConfig = &MiLightRemoteConfig::ALL_REMOTES[type]->radioConfig;
+
+    for (size_t i = 0; i < MiLightRadioConfig::NUM_CONFIGS; i++) {
+      if (&MiLightRadioConfig::ALL_CONFIGS[i] == radioConfig) {
+        listenScheduler.setPreferred(i, true);
+      }
+    }
+  }
 }
 
 size_t RadioSwitchboard::getNumRadios() const {
@@ -46,29 +91,187 @@ std::shared_ptr<MiLightRadio> RadioSwitchboard::switchRadio(const MiLightRemoteC
   return radio;
 }
 
+bool RadioSwitchboard::hasDedicatedListenRadio() const {
+  return !listenRadios.empty();
+}
+
+bool RadioSwitchboard::hasIrq() const {
+  return irq != nullptr;
+}
+
+bool RadioSwitchboard::irqPending() const {
+  return irq != nullptr && irq->pending();
+}
+
+ListenScheduler& RadioSwitchboard::getListenScheduler() {
+  return listenScheduler;
+}
+
+const ListenScheduler& RadioSwitchboard::getListenScheduler() const {
+  return listenScheduler;
+}
+
+std::shared_ptr<MiLightRadio> RadioSwitchboard::switchListenRadio(size_t radioIx) {
+  if (!hasDedicatedListenRadio()) {
+    return switchRadio(radioIx);
+  }
+
+  if (radioIx >= listenRadios.size()) {
+    return NULL;
+  }
+
+  if (this->currentListenRadio != listenRadios[radioIx]) {
+    this->currentListenRadio = listenRadios[radioIx];
+    this->currentListenRadio->configure();
+  }
+
+  return this->currentListenRadio;
+}
+
+std::shared_ptr<MiLightRadio> RadioSwitchboard::switchListenRadio(const MiLightRemoteConfig* remote) {
+  if (!hasDedicatedListenRadio()) {
+    return switchRadio(remote);
+  }
+
+  std::shared_ptr<MiLightRadio> radio = NULL;
+
+  for (size_t i = 0; i < listenRadios.size(); i++) {
+    if (&this->listenRadios[i]->config() == &remote->radioConfig) {
+      radio = switchListenRadio(i);
+      break;
+    }
+  }
+
+  return radio;
+}
+
 void RadioSwitchboard::write(uint8_t* packet, size_t len) {
   if (this->currentRadio == nullptr) {
     return;
   }
 
   this->currentRadio->write(packet, len);
+
+  if (hasDedicatedListenRadio()) {
+    recordSentPacket(packet, len);
+  } else {
+    pollAfterSend = true;
+  }
 }
 
 size_t RadioSwitchboard::read(uint8_t* packet) {
-  if (currentRadio == nullptr) {
+  std::shared_ptr<MiLightRadio> radio = receivingRadio();
+
+  if (radio == nullptr) {
     return 0;
   }
 
   size_t length;
-  currentRadio->read(packet, length);
+  radio->read(packet, length);
+
+  // A dedicated listen radio hears everything the send radio transmits
+  if (hasDedicatedListenRadio() && isOwnPacket(packet, length)) {
+    return 0;
+  }
 
   return length;
 }
 
+std::shared_ptr<MiLightRadio> RadioSwitchboard::receivingRadio() const {
+  return hasDedicatedListenRadio() ? currentListenRadio : currentRadio;
+}
+
+void RadioSwitchboard::recordSentPacket(const uint8_t* packet, size_t length) {
+  if (length > MILIGHT_MAX_PACKET_LENGTH) {
+    return;
+  }
+
+  SentPacket* last = &recentlySent[recentlySentIx];
+
+  // Repeats of the same packet only refresh the timestamp
+  if (last->length != length || memcmp(last->packet, packet, length) != 0) {
+    recentlySentIx = (recentlySentIx + 1) % MILIGHT_RECENTLY_SENT_PACKETS;
+    last = &recentlySent[recentlySentIx];
+    memcpy(last->packet, packet, length);
+    last->length = length;
+  }
+
+  last->sentAt = millis();
+}
+
+bool RadioSwitchboard::isOwnPacket(const uint8_t* packet, size_t length) const {
+  unsigned long now = millis();
+
+  for (size_t i = 0; i < MILIGHT_RECENTLY_SENT_PACKETS; i++) {
+    const SentPacket& sent = recentlySent[i];
+
+    if (sent.length == length
+      && sent.length > 0
+      && (now - sent.sentAt) <= MILIGHT_OWN_PACKET_ECHO_WINDOW
+      && memcmp(sent.packet, packet, length) == 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool RadioSwitchboard::isRepeatedPacket(const uint8_t* packet, const MiLightRemoteConfig& remoteConfig) {
+  return receivedPacketFilter.isDuplicate(packet, remoteConfig);
+}
+
+const ReceivedPacketFilter& RadioSwitchboard::getReceivedPacketFilter() const {
+  return receivedPacketFilter;
+}
+
+MiLightRadioStats RadioSwitchboard::getRadioStats() const {
+  MiLightRadioStats total;
+
+  for (const auto& radio : radios) {
+    MiLightRadioStats stats = radio->stats();
+    total.packetsSeen += stats.packetsSeen;
+    total.crcFailures += stats.crcFailures;
+    total.duplicates += stats.duplicates;
+  }
+
+  for (const auto& radio : listenRadios) {
+    MiLightRadioStats stats = radio->stats();
+    total.packetsSeen += stats.packetsSeen;
+    total.crcFailures += stats.crcFailures;
+    total.duplicates += stats.duplicates;
+  }
+
+  if (irq != nullptr) {
+    total.irqEvents = irq->numEvents();
+    total.irqOverflows = irq->numOverflows();
+    total.irqMaxLatency = irqMaxLatency;
+  }
+
+  return total;
+}
+
 bool RadioSwitchboard::available() {
-  if (currentRadio == nullptr) {
+  std::shared_ptr<MiLightRadio> radio = receivingRadio();
+
+  if (radio == nullptr) {
     return false;
   }
 
-  return currentRadio->available();
+  // With an IRQ, only touch the radio when it has signalled a packet (or as a
+  // periodic fallback in case an edge was missed)
+  if (irq != nullptr) {
+    unsigned long now = millis();
+    unsigned long arrivedAt;
+
+    if (irq->take(arrivedAt)) {
+      irqMaxLatency = std::max(irqMaxLatency, now - arrivedAt);
+    } else if (!pollAfterSend && now - lastIrqPoll < MILIGHT_IRQ_POLL_INTERVAL) {
+      return false;
+    }
+
+    lastIrqPoll = now;
+    pollAfterSend = false;
+  }
+
+  return radio->available();
 }
\ No newline at end of file
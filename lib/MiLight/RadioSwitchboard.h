@@ -4,24 +4,88 @@
 #include <MiLightRemoteConfig.h>
 #include <MiLightRadioConfig.h>
 #include <MiLightRadioFactory.h>
+#include <ListenScheduler.h>
+#include <RadioIrq.h>
+#include <ReceivedPacketFilter.h>
+
+// Number of distinct recently sent packets remembered so that a dedicated listen
+// radio doesn't report them back as packets from another transmitter.
+#ifndef MILIGHT_RECENTLY_SENT_PACKETS
+#define MILIGHT_RECENTLY_SENT_PACKETS 4
+#endif
+
+// Packets heard by the listen radio within this long of being sent are our own.
+#ifndef MILIGHT_OWN_PACKET_ECHO_WINDOW
+#define MILIGHT_OWN_PACKET_ECHO_WINDOW 1000
+#endif
 
 class RadioSwitchboard {
 public:
   RadioSwitchboard(
     std::shared_ptr<MiLightRadioFactory> radioFactory,
     GroupStateStore* stateStore,
-    Settings& settings
+    Settings& settings,
+    std::shared_ptr<MiLightRadioFactory> listenRadioFactory = nullptr
   );
 
   std::shared_ptr<MiLightRadio> switchRadio(const MiLightRemoteConfig* remote);
   std::shared_ptr<MiLightRadio> switchRadio(size_t index);
   size_t getNumRadios() const;
 
+  // Select the radio config to listen on.  Uses the dedicated listen radio if there
+  // is one, otherwise the same radio used to send.
+  std::shared_ptr<MiLightRadio> switchListenRadio(const MiLightRemoteConfig* remote);
+  std::shared_ptr<MiLightRadio> switchListenRadio(size_t index);
+  bool hasDedicatedListenRadio() const;
+
+  // True if reception is interrupt driven, and if there are interrupts that haven't
+  // been drained yet
+  bool hasIrq() const;
+  bool irqPending() const;
+
+  ListenScheduler& getListenScheduler();
+  const ListenScheduler& getListenScheduler() const;
+
   bool available();
   void write(uint8_t* packet, size_t length);
   size_t read(uint8_t* packet);
 
+  // Returns true if a received packet repeats a button press that was already
+  // handled.  Call once per decoded packet.
+  bool isRepeatedPacket(const uint8_t* packet, const MiLightRemoteConfig& remoteConfig);
+  const ReceivedPacketFilter& getReceivedPacketFilter() const;
+
+  // Receive counters summed across all radios
+  MiLightRadioStats getRadioStats() const;
+
 private:
+  struct SentPacket {
+    uint8_t packet[MILIGHT_MAX_PACKET_LENGTH];
+    size_t length;
+    unsigned long sentAt;
+  };
+
   std::vector<std::shared_ptr<MiLightRadio>> radios;
   std::shared_ptr<MiLightRadio> currentRadio;
-};
\ No newline at end of file
+
+  std::vector<std::shared_ptr<MiLightRadio>> listenRadios;
+  std::shared_ptr<MiLightRadio> currentListenRadio;
+
+  ListenScheduler listenScheduler;
+  ReceivedPacketFilter receivedPacketFilter;
+
+  std::unique_ptr<RadioIrq> irq;
+  unsigned long lastIrqPoll;
+  unsigned long irqMaxLatency;
+
+  // Set after the receiving radio has transmitted.  Sending takes it out of RX mode,
+  // and only polling it puts it back, so the next poll can't wait for an interrupt.
+  bool pollAfterSend;
+
+  SentPacket recentlySent[MILIGHT_RECENTLY_SENT_PACKETS];
+  size_t recentlySentIx;
+
+  std::shared_ptr<MiLightRadio> receivingRadio() const;
+  void recordSentPacket(const uint8_t* packet, size_t length);
+  bool isOwnPacket(const uint8_t* packet, size_t length) const;
+};
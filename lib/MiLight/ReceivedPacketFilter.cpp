@@ -0,0 +1,54 @@
+#include <ReceivedPacketFilter.h>
+
+ReceivedPacketFilter::ReceivedPacketFilter()
+  : suppressedCount(0)
+{
+  for (size_t i = 0; i < MILIGHT_RECEIVED_PACKET_FILTER_SIZE; i++) {
+    entries[i].remoteConfig = NULL;
+    entries[i].keyLength = 0;
+    entries[i].lastSeen = 0;
+  }
+}
+
+bool ReceivedPacketFilter::isDuplicate(const uint8_t* packet, const MiLightRemoteConfig& remoteConfig) {
+  uint8_t key[MILIGHT_MAX_PACKET_LENGTH];
+  size_t keyLength = remoteConfig.packetFormatter->packetKey(packet, key);
+  unsigned long now = millis();
+  Entry* oldest = &entries[0];
+
+  for (size_t i = 0; i < MILIGHT_RECEIVED_PACKET_FILTER_SIZE; i++) {
+    Entry& entry = entries[i];
+
+    if (entry.remoteConfig == &remoteConfig
+      && entry.keyLength == keyLength
+      && memcmp(entry.key, key, keyLength) == 0) {
+      bool duplicate = (now - entry.lastSeen) <= MILIGHT_RECEIVED_PACKET_FILTER_WINDOW;
+
+      // Extend the window for as long as the repeats keep coming
+      entry.lastSeen = now;
+
+      if (duplicate) {
+        suppressedCount++;
+      }
+
+      return duplicate;
+    }
+
+    // Evict an unused entry if there is one, otherwise the least recently seen
+    if (oldest->remoteConfig != NULL
+      && (entry.remoteConfig == NULL || entry.lastSeen < oldest->lastSeen)) {
+      oldest = &entry;
+    }
+  }
+
+  oldest->remoteConfig = &remoteConfig;
+  oldest->keyLength = keyLength;
+  oldest->lastSeen = now;
+  memcpy(oldest->key, key, keyLength);
+
+  return false;
+}
+
+size_t ReceivedPacketFilter::getSuppressedCount() const {
+  return suppressedCount;
+}
@@ -0,0 +1,49 @@
+#include <Arduino.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <MiLightRemoteConfig.h>
+
+#ifndef _RECEIVED_PACKET_FILTER_H
+#define _RECEIVED_PACKET_FILTER_H
+
+// Number of distinct recently received packets to remember
+#ifndef MILIGHT_RECEIVED_PACKET_FILTER_SIZE
+#define MILIGHT_RECEIVED_PACKET_FILTER_SIZE 8
+#endif
+
+// A packet identical to one received within this long is a repeat of the same
+// button press.  A new press always has a new sequence number.
+#ifndef MILIGHT_RECEIVED_PACKET_FILTER_WINDOW
+#define MILIGHT_RECEIVED_PACKET_FILTER_WINDOW 1000
+#endif
+
+/*
+ * Remotes send each button press many times, across several channels.  The radio
+ * drivers only drop a repeat of the immediately preceding packet, so repeats on
+ * alternating channels or from two remotes talking at once still reach the state
+ * pipeline.  This remembers the decoded contents of recently received packets so
+ * that each press is only handled once.
+ */
+class ReceivedPacketFilter {
+public:
+  ReceivedPacketFilter();
+
+  // Returns true if the packet repeats one received within the window.  Otherwise
+  // remembers it and returns false.
+  bool isDuplicate(const uint8_t* packet, const MiLightRemoteConfig& remoteConfig);
+
+  size_t getSuppressedCount() const;
+
+private:
+  struct Entry {
+    const MiLightRemoteConfig* remoteConfig;
+    uint8_t key[MILIGHT_MAX_PACKET_LENGTH];
+    uint8_t keyLength;
+    unsigned long lastSeen;
+  };
+
+  Entry entries[MILIGHT_RECEIVED_PACKET_FILTER_SIZE];
+  size_t suppressedCount;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#include <RepeatLearner.h>
+#include <algorithm>
+
+RepeatLearner::RepeatLearner()
+  : numLinks(0)
+{ }
+
+void RepeatLearner::recordReceivedPacket(uint16_t deviceId, uint8_t sequenceNum) {
+  LinkStats* link = findOrEvict(deviceId);
+  unsigned long now = millis();
+
+  if (link->deviceId != deviceId || link->lastHeard == 0) {
+    link->deviceId = deviceId;
+    link->lastSequenceNum = sequenceNum;
+    link->numSamples = 0;
+    link->lossEwma = 0;
+    link->lastHeard = now;
+    return;
+  }
+
+  uint8_t gap = sequenceNum - link->lastSequenceNum;
+  link->lastHeard = now;
+
+  // Same press heard again
+  if (gap == 0) {
+    return;
+  }
+
+  link->lastSequenceNum = sequenceNum;
+
+  // Remote went quiet or was reset.  Nothing to learn from this.
+  if (gap > MAX_SEQUENCE_GAP) {
+    return;
+  }
+
+  // Fraction of presses missed in this gap, and fold into the running average with
+  // a weight of 1/4.
+  int16_t sample = (((gap - 1) * 255) / gap) << LOSS_FRACTION_BITS;
+  int16_t delta = (sample - static_cast<int16_t>(link->lossEwma)) / 4;
+  link->lossEwma += delta;
+
+  if (link->numSamples < MIN_SAMPLES) {
+    link->numSamples++;
+  }
+}
+
+size_t RepeatLearner::repeatsFor(uint16_t deviceId, size_t baseRepeats, size_t minRepeats) const {
+  const LinkStats* link = find(deviceId);
+
+  if (link == NULL
+    || link->numSamples < MIN_SAMPLES
+    || (millis() - link->lastHeard) > MILIGHT_LEARNED_REPEATS_TTL) {
+    return baseRepeats;
+  }
+
+  // Loss of 25% or more is treated as a bad link and gets every repeat.
+  const uint16_t loss = link->lossEwma >> LOSS_FRACTION_BITS;
+  uint16_t lossFactor = std::min(static_cast<uint16_t>(loss * 4), static_cast<uint16_t>(255));
+  uint32_t percent = MIN_REPEAT_PERCENT + ((100 - MIN_REPEAT_PERCENT) * lossFactor) / 255;
+  size_t repeats = std::max((baseRepeats * percent) / 100, minRepeats);
+
+  return std::min(repeats, baseRepeats);
+}
+
+size_t RepeatLearner::getNumTrackedDevices() const {
+  return numLinks;
+}
+
+const RepeatLearner::LinkStats* RepeatLearner::find(uint16_t deviceId) const {
+  for (size_t i = 0; i < numLinks; i++) {
+    if (links[i].deviceId == deviceId) {
+      return &links[i];
+    }
+  }
+
+  return NULL;
+}
+
+RepeatLearner::LinkStats* RepeatLearner::findOrEvict(uint16_t deviceId) {
+  LinkStats* oldest = NULL;
+
+  for (size_t i = 0; i < numLinks; i++) {
+    if (links[i].deviceId == deviceId) {
+      return &links[i];
+    }
+    if (oldest == NULL || links[i].lastHeard < oldest->lastHeard) {
+      oldest = &links[i];
+    }
+  }
+
+  if (numLinks < MILIGHT_MAX_LEARNED_DEVICES) {
+    LinkStats* link = &links[numLinks++];
+    link->lastHeard = 0;
+    return link;
+  }
+
+  oldest->lastHeard = 0;
+  return oldest;
+}
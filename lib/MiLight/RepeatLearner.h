@@ -0,0 +1,73 @@
+#include <Arduino.h>
+#include <inttypes.h>
+#include <stddef.h>
+
+#ifndef _REPEAT_LEARNER_H
+#define _REPEAT_LEARNER_H
+
+// Number of device IDs to track link quality for.  Least recently heard device is
+// evicted when full.
+#ifndef MILIGHT_MAX_LEARNED_DEVICES
+#define MILIGHT_MAX_LEARNED_DEVICES 16
+#endif
+
+// Knowledge about a device ID is discarded if it hasn't been heard from in this long.
+#ifndef MILIGHT_LEARNED_REPEATS_TTL
+#define MILIGHT_LEARNED_REPEATS_TTL (60UL * 60UL * 1000UL)
+#endif
+
+/*
+ * Bulbs never transmit, so there's no way to confirm delivery of a packet we send.
+ * The best available signal is listening to other transmitters using the same device
+ * ID (the physical remote, or another gateway).  Each button press on a remote bumps
+ * the sequence number, so gaps in the sequence numbers we hear tell us how many
+ * presses we missed entirely.
+ *
+ * Device IDs we consistently hear are sent fewer repeats, down to a fraction of the
+ * base repeat count.  Any device ID we don't have fresh, sufficient data for gets the
+ * full base repeat count, so stale knowledge can never make delivery worse.
+ */
+class RepeatLearner {
+public:
+  // Minimum number of sequence transitions before we trust the estimate
+  static const uint8_t MIN_SAMPLES = 4;
+
+  // Gaps larger than this are treated as a remote going quiet rather than lost packets
+  static const uint8_t MAX_SEQUENCE_GAP = 16;
+
+  // Fewest repeats to use, as a percentage of the base repeat count, for a perfect link
+  static const uint8_t MIN_REPEAT_PERCENT = 25;
+
+  RepeatLearner();
+
+  // Record a packet heard from another transmitter
+  void recordReceivedPacket(uint16_t deviceId, uint8_t sequenceNum);
+
+  // Number of repeats to use for the device ID given the base (throttled) count.
+  // Never returns less than minRepeats.
+  size_t repeatsFor(uint16_t deviceId, size_t baseRepeats, size_t minRepeats) const;
+
+  size_t getNumTrackedDevices() const;
+
+private:
+  struct LinkStats {
+    uint16_t deviceId;
+    uint8_t lastSequenceNum;
+    uint8_t numSamples;
+
+    // Exponentially weighted fraction of missed presses, scaled to [0, 255] with
+    // LOSS_FRACTION_BITS extra bits so small differences still move the average
+    uint16_t lossEwma;
+    unsigned long lastHeard;
+  };
+
+  LinkStats links[MILIGHT_MAX_LEARNED_DEVICES];
+  size_t numLinks;
+
+  static const uint8_t LOSS_FRACTION_BITS = 4;
+
+  const LinkStats* find(uint16_t deviceId) const;
+  LinkStats* findOrEvict(uint16_t deviceId);
+};
+
+#endif
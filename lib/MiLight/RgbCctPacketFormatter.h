@@ -3,6 +3,7 @@
 #ifndef _RGB_CCT_PACKET_FORMATTER_H
 #define _RGB_CCT_PACKET_FORMATTER_H
 
+#define RGB_CCT_PROTOCOL_ID 0x20
 #define RGB_CCT_NUM_MODES 9
 
 #define RGB_CCT_COLOR_OFFSET 0x5F
@@ -32,7 +33,7 @@ enum MiLightRgbCctArguments {
 class RgbCctPacketFormatter : public V2PacketFormatter {
 public:
   RgbCctPacketFormatter()
-    : V2PacketFormatter(REMOTE_TYPE_RGB_CCT, 0x20, 4),
+    : V2PacketFormatter(REMOTE_TYPE_RGB_CCT, RGB_CCT_PROTOCOL_ID, 4),
       lastMode(0)
   { }
 
@@ -34,7 +34,7 @@ void RgbPacketFormatter::command(uint8_t command, uint8_t arg) {
   if (held) {
     command |= 0x80;
   }
-  currentPacket[RGB_COMMAND_INDEX] = command;
+  currentPacket()[RGB_COMMAND_INDEX] = command;
 }
 
 void RgbPacketFormatter::updateHue(uint16_t value) {
@@ -44,7 +44,7 @@ void RgbPacketFormatter::updateHue(uint16_t value) {
 
 void RgbPacketFormatter::updateColorRaw(uint8_t value) {
   command(0, 0);
-  currentPacket[RGB_COLOR_INDEX] = value;
+  currentPacket()[RGB_COLOR_INDEX] = value;
 }
 
 void RgbPacketFormatter::updateBrightness(uint8_t value) {
@@ -98,7 +98,7 @@ BulbId RgbPacketFormatter::parsePacket(const uint8_t* packet, JsonObject result)
   } else if (command == RGB_OFF) {
     result[GroupStateFieldNames::STATE] = "OFF";
   } else if (command == 0) {
-    uint16_t remappedColor = Units::rescale<uint16_t, uint16_t>(packet[RGB_COLOR_INDEX], 360.0, 255.0);
+    uint16_t remappedColor = Units::rescale<uint16_t, uint16_t>(packet[RGB_COLOR_INDEX], 360, 255);
     remappedColor = (remappedColor + 320) % 360;
     result[GroupStateFieldNames::HUE] = remappedColor;
   } else if (command == RGB_MODE_DOWN) {
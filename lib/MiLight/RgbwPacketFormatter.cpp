@@ -50,7 +50,7 @@ uint8_t RgbwPacketFormatter::currentMode() {
 
 void RgbwPacketFormatter::updateMode(uint8_t mode) {
   command(RGBW_DISCO_MODE, 0);
-  currentPacket[0] = RGBW_PROTOCOL_ID_BYTE | mode;
+  currentPacket()[0] = RGBW_PROTOCOL_ID_BYTE | mode;
 }
 
 void RgbwPacketFormatter::updateStatus(MiLightStatus status, uint8_t groupId) {
@@ -68,7 +68,7 @@ void RgbwPacketFormatter::updateBrightness(uint8_t value) {
   );
 
   command(RGBW_BRIGHTNESS, 0);
-  currentPacket[RGBW_BRIGHTNESS_GROUP_INDEX] |= (packetBrightnessValue << 3);
+  currentPacket()[RGBW_BRIGHTNESS_GROUP_INDEX] |= (packetBrightnessValue << 3);
 }
 
 void RgbwPacketFormatter::command(uint8_t command, uint8_t arg) {
@@ -76,7 +76,7 @@ void RgbwPacketFormatter::command(uint8_t command, uint8_t arg) {
   if (held) {
     command |= 0x80;
   }
-  currentPacket[RGBW_COMMAND_INDEX] = command;
+  currentPacket()[RGBW_COMMAND_INDEX] = command;
 }
 
 void RgbwPacketFormatter::updateHue(uint16_t value) {
@@ -86,7 +86,7 @@ void RgbwPacketFormatter::updateHue(uint16_t value) {
 
 void RgbwPacketFormatter::updateColorRaw(uint8_t value) {
   command(RGBW_COLOR, 0);
-  currentPacket[RGBW_COLOR_INDEX] = value;
+  currentPacket()[RGBW_COLOR_INDEX] = value;
 }
 
 void RgbwPacketFormatter::updateColorWhite() {
@@ -139,7 +139,7 @@ BulbId RgbwPacketFormatter::parsePacket(const uint8_t* packet, JsonObject result
     brightness %= 32;
     result[GroupStateFieldNames::BRIGHTNESS] = Units::rescale<uint8_t, uint8_t>(brightness, 255, 25);
   } else if (command == RGBW_COLOR) {
-    uint16_t remappedColor = Units::rescale<uint16_t, uint16_t>(packet[RGBW_COLOR_INDEX], 360.0, 255.0);
+    uint16_t remappedColor = Units::rescale<uint16_t, uint16_t>(packet[RGBW_COLOR_INDEX], 360, 255);
     remappedColor = (remappedColor + 320) % 360;
     result[GroupStateFieldNames::HUE] = remappedColor;
   } else if (command == RGBW_SPEED_DOWN) {
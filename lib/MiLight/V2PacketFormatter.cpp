@@ -10,15 +10,17 @@ V2PacketFormatter::V2PacketFormatter(const MiLightRemoteType deviceType, uint8_t
 { }
 
 bool V2PacketFormatter::canHandle(const uint8_t *packet, const size_t packetLen) {
-  uint8_t packetCopy[V2_PACKET_LEN];
-  memcpy(packetCopy, packet, V2_PACKET_LEN);
-  V2RFEncoding::decodeV2Packet(packetCopy);
+  if (packetLen != V2_PACKET_LEN) {
+    return false;
+  }
+
+  uint8_t packetProtocolId = V2RFEncoding::decodeProtocolId(packet);
 
 #ifdef DEBUG_PRINTF
-  Serial.printf_P(PSTR("Testing whether formater for ID %d can handle packet: with protocol ID %d...\n"), protocolId, packetCopy[V2_PROTOCOL_ID_INDEX]);
+  Serial.printf_P(PSTR("Testing whether formater for ID %d can handle packet: with protocol ID %d...\n"), protocolId, packetProtocolId);
 #endif
 
-  return packetCopy[V2_PROTOCOL_ID_INDEX] == protocolId;
+  return packetProtocolId == protocolId;
 }
 
 void V2PacketFormatter::initializePacket(uint8_t* packet) {
@@ -37,13 +39,17 @@ void V2PacketFormatter::initializePacket(uint8_t* packet) {
   packet[packetPtr++] = 0;
 }
 
+size_t V2PacketFormatter::getSequenceNumIndex() const {
+  return 6;
+}
+
 void V2PacketFormatter::command(uint8_t command, uint8_t arg) {
   pushPacket();
   if (held) {
     command |= 0x80;
   }
-  currentPacket[V2_COMMAND_INDEX] = command;
-  currentPacket[V2_ARGUMENT_INDEX] = arg;
+  currentPacket()[V2_COMMAND_INDEX] = command;
+  currentPacket()[V2_ARGUMENT_INDEX] = arg;
 }
 
 void V2PacketFormatter::updateStatus(MiLightStatus status, uint8_t groupId) {
@@ -60,6 +66,27 @@ void V2PacketFormatter::finalizePacket(uint8_t* packet) {
   V2RFEncoding::encodeV2Packet(packet);
 }
 
+void V2PacketFormatter::parsePacketHeader(const uint8_t* packet, uint16_t& deviceId, uint8_t& sequenceNum) {
+  uint8_t packetCopy[V2_PACKET_LEN];
+  memcpy(packetCopy, packet, V2_PACKET_LEN);
+  V2RFEncoding::decodeV2Packet(packetCopy);
+
+  deviceId = (packetCopy[2] << 8) | packetCopy[3];
+  sequenceNum = packetCopy[6];
+}
+
+size_t V2PacketFormatter::packetKey(const uint8_t* packet, uint8_t* key) {
+  uint8_t packetCopy[V2_PACKET_LEN];
+  memcpy(packetCopy, packet, V2_PACKET_LEN);
+  V2RFEncoding::decodeV2Packet(packetCopy);
+
+  // Leave out the encoding key and the checksum
+  const size_t keyLength = V2_PACKET_LEN - 2;
+  memcpy(key, packetCopy + 1, keyLength);
+
+  return keyLength;
+}
+
 void V2PacketFormatter::format(uint8_t const* packet, char* buffer) {
   buffer += sprintf_P(buffer, PSTR("Raw packet: "));
   for (size_t i = 0; i < packetLength; i++) {
@@ -26,6 +26,8 @@ public:
   virtual void unpair();
 
   virtual void finalizePacket(uint8_t* packet);
+  virtual void parsePacketHeader(const uint8_t* packet, uint16_t& deviceId, uint8_t& sequenceNum);
+  virtual size_t packetKey(const uint8_t* packet, uint8_t* key);
 
   uint8_t groupCommandArg(MiLightStatus status, uint8_t groupId);
 
@@ -49,6 +51,8 @@ public:
 protected:
   const uint8_t protocolId;
   const uint8_t numGroups;
+
+  virtual size_t getSequenceNumIndex() const;
   void switchMode(const GroupState& currentState, BulbMode desiredMode);
 };
 
@@ -6,7 +6,9 @@
   ((jumpStart > 0 && key >= jumpStart && key < jumpStart+0x80) ? 0x80 : 0) \
 )
 
-uint8_t const V2RFEncoding::V2_OFFSETS[][4] = {
+#define V2_NUM_OFFSETS 8
+
+static constexpr uint8_t V2_OFFSETS[V2_NUM_OFFSETS][4] = {
   { 0x45, 0x1F, 0x14, 0x5C }, // request type
   { 0x2B, 0xC9, 0xE3, 0x11 }, // id 1
   { 0x6D, 0x5F, 0x8A, 0x2B }, // id 2
@@ -17,7 +19,7 @@ uint8_t const V2RFEncoding::V2_OFFSETS[][4] = {
   { 0x61, 0x13, 0x38, 0x64 }  // checksum
 };
 
-uint8_t V2RFEncoding::xorKey(uint8_t key) {
+static constexpr uint8_t xorKeyConst(uint8_t key) {
   // Generate most significant nibble
   const uint8_t shift = (key & 0x0F) < 0x04 ? 0 : 1;
   const uint8_t x = (((key & 0xF0) >> 4) + shift + 6) % 8;
@@ -29,6 +31,49 @@ uint8_t V2RFEncoding::xorKey(uint8_t key) {
   return ( msn | lsn );
 }
 
+// Offsets depend only on the key mod 4 and whether the key is in the jump range, so
+// there are eight distinct rows rather than one per key
+static constexpr uint8_t offsetRow(uint8_t key) {
+  return ((key >= V2_OFFSET_JUMP_START && key < V2_OFFSET_JUMP_START + 0x80) ? 4 : 0) | (key % 4);
+}
+
+struct XorKeyTable {
+  uint8_t values[256];
+};
+
+struct OffsetTable {
+  uint8_t values[8][V2_NUM_OFFSETS];
+};
+
+static constexpr XorKeyTable buildXorKeyTable() {
+  XorKeyTable table{};
+  for (size_t i = 0; i < 256; i++) {
+    table.values[i] = xorKeyConst(i);
+  }
+  return table;
+}
+
+static constexpr OffsetTable buildOffsetTable() {
+  OffsetTable table{};
+  for (size_t row = 0; row < 8; row++) {
+    for (size_t i = 0; i < V2_NUM_OFFSETS; i++) {
+      table.values[row][i] = V2_OFFSETS[i][row % 4] + ((row & 4) ? 0x80 : 0);
+    }
+  }
+  return table;
+}
+
+static const XorKeyTable XOR_KEY_TABLE PROGMEM = buildXorKeyTable();
+static const OffsetTable OFFSET_TABLE PROGMEM = buildOffsetTable();
+
+uint8_t V2RFEncoding::xorKey(uint8_t key) {
+  return pgm_read_byte(&XOR_KEY_TABLE.values[key]);
+}
+
+uint8_t V2RFEncoding::xorKeySerial(uint8_t key) {
+  return xorKeyConst(key);
+}
+
 uint8_t V2RFEncoding::decodeByte(uint8_t byte, uint8_t s1, uint8_t xorKey, uint8_t s2) {
   uint8_t value = byte - s2;
   value = value ^ xorKey;
@@ -45,16 +90,46 @@ uint8_t V2RFEncoding::encodeByte(uint8_t byte, uint8_t s1, uint8_t xorKey, uint8
   return value;
 }
 
+uint8_t V2RFEncoding::decodeProtocolId(const uint8_t* packet) {
+  const uint8_t key = xorKey(packet[0]);
+  const uint8_t offset = pgm_read_byte(&OFFSET_TABLE.values[offsetRow(packet[0])][0]);
+
+  return (packet[1] - offset) ^ key;
+}
+
 void V2RFEncoding::decodeV2Packet(uint8_t *packet) {
-  uint8_t key = xorKey(packet[0]);
+  const uint8_t key = xorKey(packet[0]);
+  const uint8_t* offsets = OFFSET_TABLE.values[offsetRow(packet[0])];
 
   for (size_t i = 1; i <= 8; i++) {
-    packet[i] = decodeByte(packet[i], 0, key, V2_OFFSET(i, packet[0], V2_OFFSET_JUMP_START));
+    packet[i] = (packet[i] - pgm_read_byte(&offsets[i-1])) ^ key;
   }
 }
 
 void V2RFEncoding::encodeV2Packet(uint8_t *packet) {
-  uint8_t key = xorKey(packet[0]);
+  const uint8_t key = xorKey(packet[0]);
+  const uint8_t* offsets = OFFSET_TABLE.values[offsetRow(packet[0])];
+  uint8_t sum = key;
+
+  for (size_t i = 1; i <= 7; i++) {
+    sum += packet[i];
+    packet[i] = (packet[i] ^ key) + pgm_read_byte(&offsets[i-1]);
+  }
+
+  // The checksum offset never has the jump applied
+  packet[8] = ((sum + 2) ^ key) + pgm_read_byte(&OFFSET_TABLE.values[packet[0] % 4][7]);
+}
+
+void V2RFEncoding::decodeV2PacketSerial(uint8_t *packet) {
+  uint8_t key = xorKeySerial(packet[0]);
+
+  for (size_t i = 1; i <= 8; i++) {
+    packet[i] = decodeByte(packet[i], 0, key, V2_OFFSET(i, packet[0], V2_OFFSET_JUMP_START));
+  }
+}
+
+void V2RFEncoding::encodeV2PacketSerial(uint8_t *packet) {
+  uint8_t key = xorKeySerial(packet[0]);
   uint8_t sum = key;
 
   for (size_t i = 1; i <= 7; i++) {
@@ -10,12 +10,22 @@ class V2RFEncoding {
 public:
   static void encodeV2Packet(uint8_t* packet);
   static void decodeV2Packet(uint8_t* packet);
+
+  // Decode only the protocol ID byte of an encoded packet
+  static uint8_t decodeProtocolId(const uint8_t* packet);
+
   static uint8_t xorKey(uint8_t key);
   static uint8_t encodeByte(uint8_t byte, uint8_t s1, uint8_t xorKey, uint8_t s2);
   static uint8_t decodeByte(uint8_t byte, uint8_t s1, uint8_t xorKey, uint8_t s2);
 
-private:
-  static uint8_t const V2_OFFSETS[][4];
+  /**
+   * Versions of the above that compute the XOR key and offsets for every byte.  The
+   * lookup tables used by the fast versions are generated the same way, and these are
+   * kept around to validate them.
+   */
+  static void encodeV2PacketSerial(uint8_t* packet);
+  static void decodeV2PacketSerial(uint8_t* packet);
+  static uint8_t xorKeySerial(uint8_t key);
 };
 
 #endif
@@ -1,9 +1,10 @@
 #include <GroupState.h>
 #include <Units.h>
 #include <MiLightRemoteConfig.h>
-#include <RGBConverter.h>
+#include <ColorConversion.h>
 #include <BulbId.h>
 #include <MiLightCommands.h>
+#include <algorithm>
 
 static const char* BULB_MODE_NAMES[] = {
   "white",
@@ -32,6 +33,22 @@ static const GroupStateField ALL_SCRATCH_FIELDS[] = {
 // Number of units each increment command counts for
 static const uint8_t INCREMENT_COMMAND_VALUE = 10;
 
+// Number of increment commands that span the full range of a field
+static const uint8_t INCREMENT_COMMAND_RANGE = 100 / INCREMENT_COMMAND_VALUE;
+
+// Maximum representable number of steps since calibration
+static const uint8_t MAX_TRACKED_STEPS = 15;
+
+// Coarse clock used to age step positions.  Wraps every ~45 days.
+static uint16_t stepPositionClock() {
+  return millis() / 60000UL;
+}
+
+// Seconds, offset by one so that zero can mean "never"
+static uint32_t syncClock() {
+  return millis() / 1000UL + 1;
+}
+
 static const GroupState DEFAULT_STATE = GroupState();
 static const GroupState DEFAULT_RGB_ONLY_STATE = GroupState::initDefaultRgbState();
 static const GroupState DEFAULT_WHITE_ONLY_STATE = GroupState::initDefaultWhiteState();
@@ -90,15 +107,14 @@ void GroupState::initFields() {
   state.fields._isSetNightMode       = 0;
   state.fields._isNightMode          = 0;
 
-  scratchpad.fields._isSetBrightnessScratch = 0;
-  scratchpad.fields._brightnessScratch      = 0;
-  scratchpad.fields._isSetKelvinScratch     = 0;
-  scratchpad.fields._kelvinScratch          = 0;
+  for (size_t i = 0; i < SCRATCH_LONGS; i++) {
+    scratchpad.rawData[i] = 0;
+  }
 }
 
 GroupState& GroupState::operator=(const GroupState& other) {
   memcpy(state.rawData, other.state.rawData, DATA_LONGS * sizeof(uint32_t));
-  scratchpad.rawData = other.scratchpad.rawData;
+  scratchpad = other.scratchpad;
   return *this;
 }
 
@@ -112,7 +128,7 @@ GroupState::GroupState(const GroupState& other)
   : previousState(NULL)
 {
   memcpy(state.rawData, other.state.rawData, DATA_LONGS * sizeof(uint32_t));
-  scratchpad.rawData = other.scratchpad.rawData;
+  scratchpad = other.scratchpad;
 }
 
 GroupState::GroupState(const GroupState* previousState, JsonObject jsonState)
@@ -631,6 +647,25 @@ bool GroupState::applyIncrementCommand(GroupStateField field, IncrementDirection
   }
 
   int8_t dirValue = static_cast<int8_t>(dir);
+  bool down = dir == IncrementDirection::DECREASE;
+  StepTracking tracking = getStepTracking(field);
+
+  // Extend or restart the run of increments in this direction
+  if (tracking.sweep > 0 && tracking.sweepDown == down) {
+    tracking.sweep = std::min(static_cast<uint8_t>(tracking.sweep + 1), INCREMENT_COMMAND_RANGE);
+  } else {
+    tracking.sweep = 1;
+    tracking.sweepDown = down;
+  }
+  setStepTracking(field, tracking);
+
+  // A full range of increments in one direction saturates the bulb at that extreme no
+  // matter where it started, so we know its position for certain.
+  if (tracking.sweep == INCREMENT_COMMAND_RANGE) {
+    setFieldValue(field, down ? 0 : 100);
+    learnStepPosition(field, StepPositionSource::CALIBRATED);
+    return true;
+  }
 
   // If there's already a known value, update it
   if (previousState != NULL && previousState->isSetField(field)) {
@@ -641,6 +676,16 @@ bool GroupState::applyIncrementCommand(GroupStateField field, IncrementDirection
     previousState->debugState("Updating field from increment command");
 #endif
 
+    // Increments past an extreme don't move the bulb if we're right about where it is,
+    // so only count ones that do against our confidence.
+    if (newValue >= 0 && newValue <= 100) {
+      if (tracking.source == StepPositionSource::CALIBRATED) {
+        tracking.source = StepPositionSource::TRACKED;
+      }
+      tracking.steps = std::min(static_cast<uint8_t>(tracking.steps + 1), MAX_TRACKED_STEPS);
+      setStepTracking(field, tracking);
+    }
+
     // For now, assume range for both brightness and kelvin is [0, 100]
     setFieldValue(field, constrain(newValue, 0, 100));
 
@@ -650,14 +695,15 @@ bool GroupState::applyIncrementCommand(GroupStateField field, IncrementDirection
     if (isSetScratchField(field)) {
       int8_t newValue = static_cast<int8_t>(getScratchFieldValue(field)) + dirValue;
 
-      if (newValue == 0 || newValue == 10) {
+      if (newValue == 0 || newValue == INCREMENT_COMMAND_RANGE) {
         setFieldValue(field, newValue * INCREMENT_COMMAND_VALUE);
+        learnStepPosition(field, StepPositionSource::INFERRED);
         return true;
       } else {
         setScratchFieldValue(field, newValue);
       }
     } else if (dir == IncrementDirection::DECREASE) {
-      setScratchFieldValue(field, 9);
+      setScratchFieldValue(field, INCREMENT_COMMAND_RANGE - 1);
     } else {
       setScratchFieldValue(field, 1);
     }
@@ -673,6 +719,91 @@ bool GroupState::applyIncrementCommand(GroupStateField field, IncrementDirection
   return false;
 }
 
+bool GroupState::isStepPositionTrusted(GroupStateField field) const {
+  if (!isSetField(field)) {
+    return false;
+  }
+
+  StepTracking tracking = getStepTracking(field);
+
+  return (tracking.source == StepPositionSource::CALIBRATED || tracking.source == StepPositionSource::TRACKED)
+    && tracking.steps < MILIGHT_STEP_POSITION_MAX_STEPS
+    && getStepPositionAge(field) < MILIGHT_STEP_POSITION_TTL;
+}
+
+StepPositionSource GroupState::getStepPositionSource(GroupStateField field) const {
+  return getStepTracking(field).source;
+}
+
+uint8_t GroupState::getStepsSinceCalibration(GroupStateField field) const {
+  return getStepTracking(field).steps;
+}
+
+uint16_t GroupState::getStepPositionAge(GroupStateField field) const {
+  return stepPositionClock() - getStepTracking(field).learnedAt;
+}
+
+void GroupState::invalidateStepPosition(GroupStateField field) {
+  StepTracking tracking = getStepTracking(field);
+  tracking.source = StepPositionSource::UNKNOWN;
+  setStepTracking(field, tracking);
+}
+
+uint32_t GroupState::getSyncAge() const {
+  if (scratchpad.fields._syncedAt == 0) {
+    return UINT32_MAX;
+  }
+  return syncClock() - scratchpad.fields._syncedAt;
+}
+
+void GroupState::markSynced() {
+  scratchpad.fields._syncedAt = syncClock();
+}
+
+void GroupState::learnStepPosition(GroupStateField field, StepPositionSource source) {
+  StepTracking tracking = getStepTracking(field);
+  tracking.source = source;
+  tracking.steps = 0;
+  tracking.learnedAt = stepPositionClock();
+  setStepTracking(field, tracking);
+}
+
+GroupState::StepTracking GroupState::getStepTracking(GroupStateField field) const {
+  StepTracking tracking;
+
+  if (field == GroupStateField::BRIGHTNESS) {
+    tracking.source    = static_cast<StepPositionSource>(scratchpad.fields._brightnessSource);
+    tracking.sweepDown = scratchpad.fields._brightnessSweepDown;
+    tracking.sweep     = scratchpad.fields._brightnessSweep;
+    tracking.steps     = scratchpad.fields._brightnessSteps;
+    tracking.learnedAt = scratchpad.fields._brightnessLearnedAt;
+  } else {
+    tracking.source    = static_cast<StepPositionSource>(scratchpad.fields._kelvinSource);
+    tracking.sweepDown = scratchpad.fields._kelvinSweepDown;
+    tracking.sweep     = scratchpad.fields._kelvinSweep;
+    tracking.steps     = scratchpad.fields._kelvinSteps;
+    tracking.learnedAt = scratchpad.fields._kelvinLearnedAt;
+  }
+
+  return tracking;
+}
+
+void GroupState::setStepTracking(GroupStateField field, const StepTracking& tracking) {
+  if (field == GroupStateField::BRIGHTNESS) {
+    scratchpad.fields._brightnessSource    = static_cast<uint8_t>(tracking.source);
+    scratchpad.fields._brightnessSweepDown = tracking.sweepDown;
+    scratchpad.fields._brightnessSweep     = tracking.sweep;
+    scratchpad.fields._brightnessSteps     = tracking.steps;
+    scratchpad.fields._brightnessLearnedAt = tracking.learnedAt;
+  } else {
+    scratchpad.fields._kelvinSource    = static_cast<uint8_t>(tracking.source);
+    scratchpad.fields._kelvinSweepDown = tracking.sweepDown;
+    scratchpad.fields._kelvinSweep     = tracking.sweep;
+    scratchpad.fields._kelvinSteps     = tracking.steps;
+    scratchpad.fields._kelvinLearnedAt = tracking.learnedAt;
+  }
+}
+
 bool GroupState::clearNonMatchingFields(const GroupState& other) {
 #ifdef STATE_DEBUG
   this->debugState("Clearing fields.  Current state");
@@ -727,6 +858,9 @@ void GroupState::patch(const GroupState& other) {
     if (isOn() && other.isSetScratchField(field)) {
       setScratchFieldValue(field, other.getScratchFieldValue(field));
     }
+    if (isOn()) {
+      setStepTracking(field, other.getStepTracking(field));
+    }
   }
 }
 
@@ -1008,17 +1142,11 @@ bool GroupState::isSetColor() const {
 
 ParsedColor GroupState::getColor() const {
   uint8_t rgb[3];
-  RGBConverter converter;
   uint16_t hue = getHue();
+  // Default to fully saturated
   uint8_t sat = isSetSaturation() ? getSaturation() : 100;
 
-  converter.hsvToRgb(
-    hue / 360.0,
-    // Default to fully saturated
-    sat / 100.0,
-    1,
-    rgb
-  );
+  ColorConversion::hsvToRgb(hue, sat, rgb);
 
   return {
     .success = true,
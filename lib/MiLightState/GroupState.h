@@ -26,6 +26,29 @@ enum class IncrementDirection : unsigned {
   DECREASE = -1U
 };
 
+// How the position of a field that can only be changed with increment commands was
+// learned.
+enum class StepPositionSource : uint8_t {
+  // Restored from persisted state, or never learned
+  UNKNOWN    = 0,
+  // Inferred from partial increments by assuming they started at the far extreme
+  INFERRED   = 1,
+  // Followed relative steps from a known position
+  TRACKED    = 2,
+  // Bulb was driven all the way to an extreme, so its position is certain
+  CALIBRATED = 3
+};
+
+// Position tracking is trusted for at most this many relative steps since calibration
+#ifndef MILIGHT_STEP_POSITION_MAX_STEPS
+#define MILIGHT_STEP_POSITION_MAX_STEPS 15
+#endif
+
+// ... and for at most this many minutes since calibration
+#ifndef MILIGHT_STEP_POSITION_TTL
+#define MILIGHT_STEP_POSITION_TTL (24 * 60)
+#endif
+
 class GroupState {
 public:
   static const GroupStateField ALL_PHYSICAL_FIELDS[];
@@ -142,6 +165,28 @@ public:
   // returns true if a (real, not scratch) state change was made
   bool applyIncrementCommand(GroupStateField field, IncrementDirection dir);
 
+  // Confidence in the tracked position of an increment-only field.  Bulbs can miss
+  // packets and remotes can be used out of earshot, so relative steps from a stale
+  // or guessed position can leave the bulb somewhere other than where we think.
+  //
+  // The position is only trusted if it was calibrated (observed a run of increments
+  // long enough to saturate at an extreme) or tracked from a calibration, and neither
+  // too many relative steps nor too much time have passed since.
+  bool isStepPositionTrusted(GroupStateField field) const;
+  StepPositionSource getStepPositionSource(GroupStateField field) const;
+  uint8_t getStepsSinceCalibration(GroupStateField field) const;
+  // Minutes since the position was calibrated or inferred
+  uint16_t getStepPositionAge(GroupStateField field) const;
+  // Forget how the position was learned, forcing the next absolute update to
+  // recalibrate.
+  void invalidateStepPosition(GroupStateField field);
+
+  // Seconds since a packet for this group was last sent or received, or UINT32_MAX if
+  // there hasn't been one since boot.  Used to decide whether the state is fresh
+  // enough to skip commands that wouldn't change it.
+  uint32_t getSyncAge() const;
+  void markSynced();
+
   // Helpers that convert raw state values
 
   // Return true if hue is set.  If saturation is not set, will assume 100.
@@ -192,17 +237,43 @@ private:
 
   // Transient scratchpad that is never persisted.  Used to track and compute state for
   // protocols that only have increment commands (like CCT).
+  //
+  // The sweep fields count consecutive increments in one direction.  A full range of
+  // them saturates the bulb at an extreme regardless of where it started.
+  static const size_t SCRATCH_LONGS = 3;
   union TransientData {
-    uint16_t rawData;
+    uint32_t rawData[SCRATCH_LONGS];
     struct Fields {
-      uint16_t
+      uint32_t
         _isSetKelvinScratch     : 1,
-        _kelvinScratch          : 7,
+        _kelvinScratch          : 4,
         _isSetBrightnessScratch : 1,
-        _brightnessScratch      : 8;
+        _brightnessScratch      : 4,
+        _brightnessSource       : 2,
+        _brightnessSweepDown    : 1,
+        _brightnessSweep        : 4,
+        _brightnessSteps        : 4,
+        _kelvinSource           : 2,
+        _kelvinSweepDown        : 1,
+        _kelvinSweep            : 4,
+        _kelvinSteps            : 4;
+      uint32_t
+        _brightnessLearnedAt    : 16,
+        _kelvinLearnedAt        : 16;
+      // Zero if never synced
+      uint32_t
+        _syncedAt               : 32;
     } fields;
   };
 
+  struct StepTracking {
+    StepPositionSource source;
+    bool sweepDown;
+    uint8_t sweep;
+    uint8_t steps;
+    uint16_t learnedAt;
+  };
+
   StateData state;
   TransientData scratchpad;
 
@@ -212,6 +283,10 @@ private:
   // it here.
   const GroupState* previousState;
 
+  StepTracking getStepTracking(GroupStateField field) const;
+  void setStepTracking(GroupStateField field, const StepTracking& tracking);
+  void learnStepPosition(GroupStateField field, StepPositionSource source);
+
   void applyColor(JsonObject state, uint8_t r, uint8_t g, uint8_t b) const;
   void applyColor(JsonObject state) const;
   // Apply OpenHAB-style color, e.g., {"color":"0,0,0"}
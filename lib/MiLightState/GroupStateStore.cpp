@@ -54,6 +54,7 @@ GroupState* GroupStateStore::set(const BulbId &id, const GroupState& state) {
   BulbId otherId(id);
   GroupState* storedState = get(id);
   storedState->patch(state);
+  storedState->markSynced();
 
   if (id.groupId == 0) {
     const MiLightRemoteConfig* remote = MiLightRemoteConfig::fromType(id.deviceType);
@@ -68,6 +69,7 @@ GroupState* GroupStateStore::set(const BulbId &id, const GroupState& state) {
 
       GroupState* individualState = get(otherId);
       individualState->patch(state);
+      individualState->markSynced();
     }
   } else {
     otherId.groupId = 0;
@@ -149,3 +151,7 @@ void GroupStateStore::limitedFlush() {
     }
   }
 }
+
+ListNode<GroupCacheNode*>* GroupStateStore::getCachedStates() {
+  return cache.getHead();
+}
@@ -40,6 +40,12 @@ public:
    */
   void limitedFlush();
 
+  /*
+   * First node of the in-memory cache.  Only states used since boot are reachable
+   * from here.
+   */
+  ListNode<GroupCacheNode*>* getCachedStates();
+
 private:
   GroupStateCache cache;
   GroupStatePersistence persistence;
@@ -18,6 +18,7 @@
 LT8900MiLightRadio::LT8900MiLightRadio(byte byCSPin, byte byResetPin, byte byPktFlag, const MiLightRadioConfig& config)
   : _config(config),
     _channel(0),
+    _dupes_received(0),
     _currentPacketLen(0),
     _currentPacketPos(0)
 {
@@ -56,6 +57,7 @@ LT8900MiLightRadio::LT8900MiLightRadio(byte byCSPin, byte byResetPin, byte byPkt
   //Reset SPI MODE to default
   SPI.setDataMode(SPI_MODE0);
   _waiting = false;
+  _packet[0] = 0;
 }
 
 
@@ -202,7 +204,6 @@ uint8_t LT8900MiLightRadio::uiWriteRegister(uint8_t reg, uint16_t data)
 /**************************************************************************/
 void LT8900MiLightRadio::vStartListening(uint uiChannelToListenTo)
 {
-  _dupes_received = 0;
   vSetSyncWord(_config.syncword3, 0,0,_config.syncword0);
 	//vSetChannel(uiChannelToListenTo);
 
@@ -217,7 +218,6 @@ void LT8900MiLightRadio::vStartListening(uint uiChannelToListenTo)
 /**************************************************************************/
 void LT8900MiLightRadio::vResumeRX(void)
 {
-  _dupes_received = 0;
 	uiWriteRegister(R_CHANNEL, _channel & CHANNEL_MASK);   //turn off rx/tx
 	delay(3);
 	uiWriteRegister(R_FIFO_CONTROL, 0x0080);  //flush rx
@@ -242,6 +242,8 @@ bool LT8900MiLightRadio::bAvailableRegister() {
 #ifdef DEBUG_PRINTF
     Serial.println(F("LT8900: CRC failed"));
 #endif
+    _stats.packetsSeen++;
+    _stats.crcFailures++;
     vResumeRX();
     return false;
   }
@@ -358,6 +360,15 @@ int LT8900MiLightRadio::read(uint8_t frame[], size_t &frame_length)
   if (packetSize > 0) {
     frame_length = packetSize;
     memcpy(frame, buf, packetSize);
+    _stats.packetsSeen++;
+
+    // Same frame as last time is another repeat of the same packet
+    if (_packet[0] == packetSize && memcmp(_packet + 1, buf, packetSize) == 0) {
+      _dupes_received++;
+    } else {
+      _packet[0] = packetSize;
+      memcpy(_packet + 1, buf, packetSize);
+    }
   }
 
   vResumeRX();
@@ -446,6 +457,12 @@ bool LT8900MiLightRadio::sendPacket(uint8_t *data, size_t packetSize, byte byCha
   return false;
 }
 
+MiLightRadioStats LT8900MiLightRadio::stats() const {
+  MiLightRadioStats stats = _stats;
+  stats.duplicates = _dupes_received;
+  return stats;
+}
+
 const MiLightRadioConfig& LT8900MiLightRadio::config() {
   return _config;
 }
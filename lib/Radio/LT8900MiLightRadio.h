@@ -51,6 +51,7 @@ class LT8900MiLightRadio : public MiLightRadio {
     virtual int resend();
     virtual int configure();
     virtual const MiLightRadioConfig& config();
+    virtual MiLightRadioStats stats() const;
 
   private:
 
@@ -83,6 +84,7 @@ class LT8900MiLightRadio : public MiLightRadio {
     int _dupes_received;
     size_t _currentPacketLen;
     size_t _currentPacketPos;
+    MiLightRadioStats _stats;
 };
 
 
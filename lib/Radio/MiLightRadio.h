@@ -11,6 +11,19 @@
 #ifndef _MILIGHT_RADIO_H_
 #define _MILIGHT_RADIO_H_
 
+// Receive counters, used to measure how many packets are being captured
+struct MiLightRadioStats {
+  // Frames read off the radio, including ones that were later discarded
+  size_t packetsSeen = 0;
+  size_t crcFailures = 0;
+  size_t duplicates = 0;
+
+  // Packet-ready interrupts, and ones dropped because the main loop fell behind
+  size_t irqEvents = 0;
+  size_t irqOverflows = 0;
+  unsigned long irqMaxLatency = 0;
+};
+
 class MiLightRadio {
   public:
 
@@ -21,6 +34,7 @@ class MiLightRadio {
     virtual int resend() = 0;
     virtual int configure() = 0;
     virtual const MiLightRadioConfig& config() = 0;
+    virtual MiLightRadioStats stats() const = 0;
 
 };
 
@@ -19,6 +19,29 @@ std::shared_ptr<MiLightRadioFactory> MiLightRadioFactory::fromSettings(const Set
   }
 }
 
+std::shared_ptr<MiLightRadioFactory> MiLightRadioFactory::listenFromSettings(const Settings& settings) {
+  if (! settings.listenRadioEnabled) {
+    return NULL;
+  }
+
+  switch (settings.listenRadioInterfaceType) {
+    case nRF24:
+      return std::make_shared<NRF24Factory>(
+        settings.listenCsnPin,
+        settings.listenCePin,
+        settings.rf24PowerLevel,
+        settings.rf24Channels,
+        settings.rf24ListenChannel
+      );
+
+    case LT8900:
+      return std::make_shared<LT8900Factory>(settings.listenCsnPin, settings.listenResetPin, settings.listenCePin);
+
+    default:
+      return NULL;
+  }
+}
+
 NRF24Factory::NRF24Factory(
   uint8_t csnPin,
   uint8_t cePin,
@@ -21,6 +21,10 @@ public:
 
   static std::shared_ptr<MiLightRadioFactory> fromSettings(const Settings& settings);
 
+  // Factory for the optional second radio used only for listening.  Returns NULL if
+  // no listen radio is configured.
+  static std::shared_ptr<MiLightRadioFactory> listenFromSettings(const Settings& settings);
+
 };
 
 class NRF24Factory : public MiLightRadioFactory {
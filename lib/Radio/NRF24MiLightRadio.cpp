@@ -15,7 +15,9 @@ NRF24MiLightRadio::NRF24MiLightRadio(
     listenChannelIx(static_cast<size_t>(listenChannel)),
     _pl1167(PL1167_nRF24(rf24)),
     _config(config),
-    _waiting(false)
+    _prev_packet_id(0),
+    _waiting(false),
+    _dupes_received(0)
 { }
 
 int NRF24MiLightRadio::begin() {
@@ -137,3 +139,11 @@ int NRF24MiLightRadio::resend() {
 const MiLightRadioConfig& NRF24MiLightRadio::config() {
   return _config;
 }
+
+MiLightRadioStats NRF24MiLightRadio::stats() const {
+  MiLightRadioStats stats;
+  stats.packetsSeen = _pl1167.framesReceived();
+  stats.crcFailures = _pl1167.crcFailures();
+  stats.duplicates = _dupes_received;
+  return stats;
+}
@@ -28,11 +28,11 @@ class NRF24MiLightRadio : public MiLightRadio {
     int begin();
     bool available();
     int read(uint8_t frame[], size_t &frame_length);
-    int dupesReceived();
     int write(uint8_t frame[], size_t frame_length);
     int resend();
     int configure();
     const MiLightRadioConfig& config();
+    MiLightRadioStats stats() const;
 
   private:
     const std::vector<RF24Channel>& channels;
@@ -14,8 +14,6 @@
 #include <RadioUtils.h>
 #include <MiLightRadioConfig.h>
 
-static uint16_t calc_crc(uint8_t *data, size_t data_length);
-
 PL1167_nRF24::PL1167_nRF24(RF24 &radio)
   : _radio(radio)
 { }
@@ -26,6 +24,9 @@ int PL1167_nRF24::open() {
   _radio.setDataRate(RF24_1MBPS);
   _radio.disableCRC();
 
+  // Only assert IRQ for received packets
+  _radio.maskIRQ(true, true, false);
+
   _syncwordLength = MiLightRadioConfig::SYNCWORD_LENGTH;
   _radio.setAddressWidth(_syncwordLength);
 
@@ -110,6 +111,7 @@ int PL1167_nRF24::readFIFO(uint8_t data[], size_t &data_length)
   if (_packet_length) {
     memmove(_packet, _packet + data_length, _packet_length);
   }
+  _tx_frame_length = 0;
   return _packet_length;
 }
 
@@ -118,9 +120,16 @@ int PL1167_nRF24::writeFIFO(const uint8_t data[], size_t data_length)
   if (data_length > sizeof(_packet)) {
     data_length = sizeof(_packet);
   }
+
+  // Repeats of the same packet can keep using the already-encoded frame
+  if (_tx_frame_length > 0 && data_length == _packet_length && memcmp(_packet, data, data_length) == 0) {
+    return data_length;
+  }
+
   memcpy(_packet, data, data_length);
   _packet_length = data_length;
   _received = false;
+  _tx_frame_length = 0;
 
   return data_length;
 }
@@ -136,28 +145,31 @@ int PL1167_nRF24::transmit(uint8_t channel) {
   }
 
   _radio.stopListening();
-  uint8_t tmp[sizeof(_packet)];
-  int outp=0;
-
-  uint16_t crc = calc_crc(_packet, _packet_length);
-
-  // +1 for packet length
-  // +2 for crc
-  // = 3
-  for (int inp = 0; inp < _packet_length + 3; inp++) {
-    if (inp < _packet_length) {
-      tmp[outp++] = reverseBits(_packet[inp]);}
-    else if (inp < _packet_length + 2) {
-      tmp[outp++] = reverseBits((crc >> ( (inp - _packet_length) * 8)) & 0xff);
-    }
-  }
 
-  yield();
+  if (_tx_frame_length == 0) {
+    encode_tx_frame();
+    yield();
+  }
 
-  _radio.write(tmp, outp);
+  _radio.write(_tx_frame, _tx_frame_length);
   return 0;
 }
 
+void PL1167_nRF24::encode_tx_frame() {
+  uint8_t outp = 0;
+  uint16_t crc = pl1167Crc(_packet, _packet_length);
+
+  for (uint8_t inp = 0; inp < _packet_length; inp++) {
+    _tx_frame[outp++] = reverseBits(_packet[inp]);
+  }
+
+  // CRC is sent little-endian
+  _tx_frame[outp++] = reverseBits(crc & 0xFF);
+  _tx_frame[outp++] = reverseBits(crc >> 8);
+
+  _tx_frame_length = outp;
+}
+
 /**
  * The over-the-air packet structure sent by the PL1167 is as follows (lengths
  * measured in bits)
@@ -174,9 +186,16 @@ int PL1167_nRF24::internal_receive() {
   int outp = 0;
 
   _radio.read(tmp, _receive_length);
-
-  // HACK HACK HACK: Reset radio
-  open();
+  _frames_received++;
+
+  // Drain anything else sitting in the RX FIFO (noise or further repeats of this
+  // packet) so the next read sees a fresh frame.  The radio stays in RX mode.  These
+  // still count as frames seen.
+  uint8_t discard[sizeof(_packet)];
+  while (_radio.available()) {
+    _radio.read(discard, _receive_length);
+    _frames_received++;
+  }
 
 // Currently, the syncword width is set to 5 in order to include the
 // PL1167 trailer.  The trailer is 4 bits, which pushes packet data
@@ -216,16 +235,18 @@ int PL1167_nRF24::internal_receive() {
 #ifdef DEBUG_PRINTF
     Serial.println(F("Failed CRC: outp < 2"));
 #endif
+    _crc_failures++;
     return 0;
   }
 
-  uint16_t crc = calc_crc(tmp, outp - 2);
+  uint16_t crc = pl1167Crc(tmp, outp - 2);
   uint16_t recvCrc = (tmp[outp - 1] << 8) | tmp[outp - 2];
 
   if ( crc != recvCrc ) {
 #ifdef DEBUG_PRINTF
     Serial.printf_P(PSTR("Failed CRC: expected %04X, got %04X\n"), crc, recvCrc);
 #endif
+    _crc_failures++;
     return 0;
   }
   outp -= 2;
@@ -234,6 +255,7 @@ int PL1167_nRF24::internal_receive() {
 
   _packet_length = outp;
   _received = true;
+  _tx_frame_length = 0;
 
 #ifdef DEBUG_PRINTF
   Serial.printf_P(PSTR("Successfully parsed packet of length %d\n"), _packet_length);
@@ -242,20 +264,10 @@ int PL1167_nRF24::internal_receive() {
   return outp;
 }
 
-#define CRC_POLY 0x8408
-
-static uint16_t calc_crc(uint8_t *data, size_t data_length) {
-  uint16_t state = 0;
-  for (size_t i = 0; i < data_length; i++) {
-    uint8_t byte = data[i];
-    for (int j = 0; j < 8; j++) {
-      if ((byte ^ state) & 0x01) {
-        state = (state >> 1) ^ CRC_POLY;
-      } else {
-        state = state >> 1;
-      }
-      byte = byte >> 1;
-    }
-  }
-  return state;
-}
\ No newline at end of file
+size_t PL1167_nRF24::framesReceived() const {
+  return _frames_received;
+}
+
+size_t PL1167_nRF24::crcFailures() const {
+  return _crc_failures;
+}
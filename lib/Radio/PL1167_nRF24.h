@@ -29,6 +29,9 @@ class PL1167_nRF24 {
     int receive(uint8_t channel);
     int readFIFO(uint8_t data[], size_t &data_length);
 
+    size_t framesReceived() const;
+    size_t crcFailures() const;
+
   private:
     RF24 &_radio;
 
@@ -47,8 +50,18 @@ class PL1167_nRF24 {
     uint8_t _packet[32];
     bool _received = false;
 
+    // Encoded over-the-air frame (bit-reversed payload + CRC) for the packet in
+    // _packet.  Built on first transmit and reused for repeats and other channels
+    // until the payload changes.  Zero length means it needs to be rebuilt.
+    uint8_t _tx_frame[32];
+    uint8_t _tx_frame_length = 0;
+
+    size_t _frames_received = 0;
+    size_t _crc_failures = 0;
+
     int recalc_parameters();
     int internal_receive();
+    void encode_tx_frame();
 
 };
 
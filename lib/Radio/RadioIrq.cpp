@@ -0,0 +1,57 @@
+#include <RadioIrq.h>
+
+RadioIrq::RadioIrq(uint8_t pin, int mode)
+  : pin(pin)
+  , head(0)
+  , tail(0)
+  , events(0)
+  , overflows(0)
+{
+  pinMode(pin, INPUT);
+  attachInterruptArg(digitalPinToInterrupt(pin), &RadioIrq::handleInterrupt, this, mode);
+}
+
+RadioIrq::~RadioIrq() {
+  detachInterrupt(digitalPinToInterrupt(pin));
+}
+
+void IRAM_ATTR RadioIrq::handleInterrupt(void* arg) {
+  RadioIrq* irq = static_cast<RadioIrq*>(arg);
+  uint8_t next = (irq->head + 1) % MILIGHT_IRQ_RING_SIZE;
+
+  irq->events++;
+
+  // Oldest events are kept.  Their packets are already sitting in the radio FIFO.
+  if (next == irq->tail) {
+    irq->overflows++;
+    return;
+  }
+
+  irq->arrivals[irq->head] = millis();
+  irq->head = next;
+}
+
+bool RadioIrq::take(unsigned long& arrivedAt) {
+  uint8_t currentTail = tail;
+
+  if (currentTail == head) {
+    return false;
+  }
+
+  arrivedAt = arrivals[currentTail];
+  tail = (currentTail + 1) % MILIGHT_IRQ_RING_SIZE;
+
+  return true;
+}
+
+bool RadioIrq::pending() const {
+  return tail != head;
+}
+
+size_t RadioIrq::numEvents() const {
+  return events;
+}
+
+size_t RadioIrq::numOverflows() const {
+  return overflows;
+}
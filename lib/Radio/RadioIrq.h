@@ -0,0 +1,51 @@
+#include <Arduino.h>
+#include <inttypes.h>
+#include <stddef.h>
+
+#ifndef _RADIO_IRQ_H
+#define _RADIO_IRQ_H
+
+// Number of packet-ready interrupts that can be queued before the main loop gets
+// to them.  Must be less than 256.
+#ifndef MILIGHT_IRQ_RING_SIZE
+#define MILIGHT_IRQ_RING_SIZE 8
+#endif
+
+// Poll the radio anyway if no interrupt has been seen in this long, in case an edge
+// was missed and the IRQ line is stuck asserted.
+#ifndef MILIGHT_IRQ_POLL_INTERVAL
+#define MILIGHT_IRQ_POLL_INTERVAL 1000
+#endif
+
+/*
+ * Records packet-ready interrupts from a radio module (nRF24 IRQ on RX_DR, LT8900
+ * PKT_FLAG) into a single-producer, single-consumer ring.  The ISR only stores the
+ * arrival time.  The payload stays in the radio's hardware FIFO until the main loop
+ * drains the ring, because neither RF24 nor the SPI driver are safe to call from an
+ * ISR on the ESP8266 (not IRAM resident, and the bus is shared with the main loop).
+ */
+class RadioIrq {
+public:
+  RadioIrq(uint8_t pin, int mode);
+  ~RadioIrq();
+
+  // Pop the oldest interrupt.  Returns false if none are pending.
+  bool take(unsigned long& arrivedAt);
+  bool pending() const;
+
+  size_t numEvents() const;
+  size_t numOverflows() const;
+
+private:
+  const uint8_t pin;
+
+  volatile unsigned long arrivals[MILIGHT_IRQ_RING_SIZE];
+  volatile uint8_t head;
+  volatile uint8_t tail;
+  volatile uint32_t events;
+  volatile uint32_t overflows;
+
+  static void handleInterrupt(void* arg);
+};
+
+#endif
@@ -4,7 +4,71 @@
 #include <stddef.h>
 #include <Arduino.h>
 
+#define PL1167_CRC_POLY 0x8408
+
+static constexpr uint8_t reverseBitsConst(uint8_t byte) {
+  uint8_t result = 0;
+
+  for (uint8_t i = 0; i < 8; i++) {
+    result = (result << 1) | ((byte >> i) & 1);
+  }
+
+  return result;
+}
+
+// CRC of a single byte starting from a zero state
+static constexpr uint16_t crcByteConst(uint8_t byte) {
+  uint16_t state = byte;
+
+  for (uint8_t i = 0; i < 8; i++) {
+    state = (state & 0x01) ? ((state >> 1) ^ PL1167_CRC_POLY) : (state >> 1);
+  }
+
+  return state;
+}
+
+struct ReverseBitsTable {
+  uint8_t values[256];
+};
+
+struct CrcTable {
+  uint16_t values[256];
+};
+
+static constexpr ReverseBitsTable buildReverseBitsTable() {
+  ReverseBitsTable table{};
+  for (size_t i = 0; i < 256; i++) {
+    table.values[i] = reverseBitsConst(i);
+  }
+  return table;
+}
+
+static constexpr CrcTable buildCrcTable() {
+  CrcTable table{};
+  for (size_t i = 0; i < 256; i++) {
+    table.values[i] = crcByteConst(i);
+  }
+  return table;
+}
+
+static const ReverseBitsTable REVERSE_BITS_TABLE PROGMEM = buildReverseBitsTable();
+static const CrcTable CRC_TABLE PROGMEM = buildCrcTable();
+
 uint8_t reverseBits(uint8_t byte) {
+  return pgm_read_byte(&REVERSE_BITS_TABLE.values[byte]);
+}
+
+uint16_t pl1167Crc(const uint8_t* data, size_t length) {
+  uint16_t state = 0;
+
+  for (size_t i = 0; i < length; i++) {
+    state = (state >> 8) ^ pgm_read_word(&CRC_TABLE.values[(state ^ data[i]) & 0xFF]);
+  }
+
+  return state;
+}
+
+uint8_t reverseBitsSerial(uint8_t byte) {
   uint8_t result = byte;
   uint8_t i = 7;
 
@@ -15,4 +79,20 @@ uint8_t reverseBits(uint8_t byte) {
   }
 
   return result << i;
-}
\ No newline at end of file
+}
+
+uint16_t pl1167CrcSerial(const uint8_t* data, size_t length) {
+  uint16_t state = 0;
+  for (size_t i = 0; i < length; i++) {
+    uint8_t byte = data[i];
+    for (int j = 0; j < 8; j++) {
+      if ((byte ^ state) & 0x01) {
+        state = (state >> 1) ^ PL1167_CRC_POLY;
+      } else {
+        state = state >> 1;
+      }
+      byte = byte >> 1;
+    }
+  }
+  return state;
+}
@@ -1,8 +1,22 @@
 #pragma once
 
 #include <stdint.h>
+#include <stddef.h>
 
 /**
  * Reverse the bits of a given byte
  */
-uint8_t reverseBits(uint8_t byte);
\ No newline at end of file
+uint8_t reverseBits(uint8_t byte);
+
+/**
+ * Compute the PL1167 packet CRC (CRC-16, reflected polynomial 0x8408, initial
+ * state 0)
+ */
+uint16_t pl1167Crc(const uint8_t* data, size_t length);
+
+/**
+ * Bit-at-a-time versions of the above.  The lookup tables used by the fast versions
+ * are generated from these, and they're kept around to validate the tables.
+ */
+uint8_t reverseBitsSerial(uint8_t byte);
+uint16_t pl1167CrcSerial(const uint8_t* data, size_t length);
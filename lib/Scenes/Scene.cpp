@@ -0,0 +1,326 @@
+#include <Scene.h>
+#include <Units.h>
+#include <algorithm>
+
+// Scene file layout.  Multi-byte values are little endian.
+//
+//   header:  'S' 'C' <version> <number of scenes>
+//   scene:   <id:2> <name length:1> <name> <number of members:1> <member>...
+//   member:  <device id:2> <group id:1> <device type:1>
+//            <fields:1> <status:1> <level:1> <hue:2> <saturation:1> <kelvin:1> <mode:1>
+static const uint8_t SCENE_FILE_MAGIC[] = {'S', 'C'};
+static const uint8_t SCENE_FILE_VERSION = 1;
+static const size_t SCENE_MEMBER_LENGTH = 12;
+
+static void writeUint16(Stream& stream, uint16_t value) {
+  stream.write(value & 0xFF);
+  stream.write(value >> 8);
+}
+
+static uint16_t readUint16(const uint8_t* buffer) {
+  return buffer[0] | (buffer[1] << 8);
+}
+
+SceneState::SceneState()
+  : fields(0)
+  , status(OFF)
+  , level(0)
+  , hue(0)
+  , saturation(0)
+  , kelvin(0)
+  , mode(0)
+{ }
+
+SceneState SceneState::fromUpdate(const StateUpdate& update) {
+  SceneState state;
+
+  if (update.has(StateUpdate::STATUS)) {
+    state.status = update.status;
+    state.fields |= STATUS;
+  }
+
+  if (update.has(StateUpdate::LEVEL)) {
+    state.level = update.level;
+    state.fields |= LEVEL;
+  } else if (update.has(StateUpdate::BRIGHTNESS)) {
+    state.level = Units::rescale<uint16_t, uint16_t>(update.brightness, 100, 255);
+    state.fields |= LEVEL;
+  }
+
+  // Near-white colors switch to white mode, as in MiLightClient::updateColor
+  if (update.has(StateUpdate::COLOR) && update.color.isWhite()) {
+    state.fields |= WHITE_MODE;
+  } else if (update.has(StateUpdate::COLOR)) {
+    state.hue = update.color.hue;
+    state.saturation = update.color.saturation;
+    state.fields |= HUE | SATURATION;
+  }
+  if (update.has(StateUpdate::HUE)) {
+    state.hue = update.hue;
+    state.fields |= HUE;
+  }
+  if (update.has(StateUpdate::SATURATION)) {
+    state.saturation = update.saturation;
+    state.fields |= SATURATION;
+  }
+
+  if (update.has(StateUpdate::KELVIN)) {
+    state.kelvin = update.kelvin;
+    state.fields |= KELVIN;
+  } else if (update.has(StateUpdate::COLOR_TEMP)) {
+    state.kelvin = Units::miredsToWhiteVal(update.colorTemp, 100);
+    state.fields |= KELVIN;
+  }
+
+  if (update.has(StateUpdate::MODE)) {
+    state.mode = update.mode;
+    state.fields |= MODE;
+  }
+
+  if (update.has(StateUpdate::EFFECT) && update.effect == MiLightCommand::NIGHT_MODE) {
+    state.fields |= NIGHT_MODE;
+  } else if (update.has(StateUpdate::EFFECT) && update.effect == MiLightCommand::SET_WHITE) {
+    state.fields |= WHITE_MODE;
+  }
+
+  for (uint8_t i = 0; i < update.numCommands; ++i) {
+    if (update.commands[i] == MiLightCommand::SET_WHITE) {
+      state.fields |= WHITE_MODE;
+    }
+  }
+
+  return state;
+}
+
+SceneState SceneState::fromGroupState(const GroupState& groupState) {
+  SceneState state;
+
+  if (groupState.isSetState()) {
+    state.status = groupState.getState();
+    state.fields |= STATUS;
+  }
+
+  // Fields that don't apply while off are left to whatever the bulb remembers
+  if (!groupState.isOn()) {
+    return state;
+  }
+
+  if (groupState.isSetBrightness()) {
+    state.level = groupState.getBrightness();
+    state.fields |= LEVEL;
+  }
+
+  if (!groupState.isSetBulbMode()) {
+    return state;
+  }
+
+  switch (groupState.getBulbMode()) {
+    case BULB_MODE_COLOR:
+      if (groupState.isSetHue()) {
+        state.hue = groupState.getHue();
+        state.fields |= HUE;
+      }
+      if (groupState.isSetSaturation()) {
+        state.saturation = groupState.getSaturation();
+        state.fields |= SATURATION;
+      }
+      break;
+    case BULB_MODE_WHITE:
+      if (groupState.isSetKelvin()) {
+        state.kelvin = groupState.getKelvin();
+        state.fields |= KELVIN;
+      } else {
+        state.fields |= WHITE_MODE;
+      }
+      break;
+    case BULB_MODE_SCENE:
+      if (groupState.isSetMode()) {
+        state.mode = groupState.getMode();
+        state.fields |= MODE;
+      }
+      break;
+    case BULB_MODE_NIGHT:
+      state.fields |= NIGHT_MODE;
+      break;
+  }
+
+  return state;
+}
+
+void SceneState::serialize(JsonObject json) const {
+  if (has(STATUS)) {
+    json[GroupStateFieldNames::STATE] = status == ON ? "ON" : "OFF";
+  }
+  if (has(LEVEL)) {
+    json[GroupStateFieldNames::LEVEL] = level;
+  }
+  if (has(HUE)) {
+    json[GroupStateFieldNames::HUE] = hue;
+  }
+  if (has(SATURATION)) {
+    json[GroupStateFieldNames::SATURATION] = saturation;
+  }
+  if (has(KELVIN)) {
+    json[GroupStateFieldNames::KELVIN] = kelvin;
+  }
+  if (has(MODE)) {
+    json[GroupStateFieldNames::MODE] = mode;
+  }
+  if (has(NIGHT_MODE)) {
+    json[GroupStateFieldNames::EFFECT] = MiLightCommandNames::NIGHT_MODE;
+  } else if (has(WHITE_MODE)) {
+    json[GroupStateFieldNames::EFFECT] = "white_mode";
+  }
+}
+
+Scene::Scene()
+  : id(0)
+{
+  name[0] = 0;
+}
+
+void Scene::setName(const char* name) {
+  strncpy(this->name, name, MAX_SCENE_NAME_LEN);
+  this->name[MAX_SCENE_NAME_LEN] = 0;
+}
+
+bool Scene::load(Stream& stream) {
+  uint8_t buffer[SCENE_MEMBER_LENGTH];
+
+  if (stream.readBytes(buffer, 3) != 3) {
+    Serial.println(F("ERROR: scene file invalid. truncated scene header"));
+    return false;
+  }
+
+  id = readUint16(buffer);
+  size_t nameLength = std::min(static_cast<size_t>(buffer[2]), static_cast<size_t>(MAX_SCENE_NAME_LEN));
+
+  if (stream.readBytes(name, nameLength) != nameLength) {
+    Serial.println(F("ERROR: scene file invalid. truncated scene name"));
+    return false;
+  }
+  name[nameLength] = 0;
+
+  // Skip whatever didn't fit so that the rest of the file stays aligned
+  for (size_t i = nameLength; i < buffer[2]; ++i) {
+    if (stream.read() < 0) {
+      Serial.println(F("ERROR: scene file invalid. truncated scene name"));
+      return false;
+    }
+  }
+
+  int numMembers = stream.read();
+  if (numMembers < 0) {
+    Serial.println(F("ERROR: scene file invalid. missing member count"));
+    return false;
+  }
+
+  members.clear();
+  members.reserve(numMembers);
+
+  for (int i = 0; i < numMembers; ++i) {
+    if (stream.readBytes(buffer, SCENE_MEMBER_LENGTH) != SCENE_MEMBER_LENGTH) {
+      Serial.printf_P(PSTR("ERROR: scene file invalid. truncated member %d of scene %u\n"), i, id);
+      return false;
+    }
+
+    SceneMember member;
+    member.bulbId = BulbId(readUint16(buffer), buffer[2], static_cast<MiLightRemoteType>(buffer[3]));
+    member.state.fields = buffer[4];
+    member.state.status = static_cast<MiLightStatus>(buffer[5]);
+    member.state.level = buffer[6];
+    member.state.hue = readUint16(buffer + 7);
+    member.state.saturation = buffer[9];
+    member.state.kelvin = buffer[10];
+    member.state.mode = buffer[11];
+
+    members.push_back(member);
+  }
+
+  return true;
+}
+
+void Scene::dump(Stream& stream) const {
+  const uint8_t nameLength = strlen(name);
+  const uint8_t numMembers = std::min(members.size(), static_cast<size_t>(MILIGHT_MAX_SCENE_MEMBERS));
+
+  writeUint16(stream, id);
+  stream.write(nameLength);
+  stream.write(reinterpret_cast<const uint8_t*>(name), nameLength);
+  stream.write(numMembers);
+
+  for (size_t i = 0; i < numMembers; ++i) {
+    const SceneMember& member = members[i];
+
+    writeUint16(stream, member.bulbId.deviceId);
+    stream.write(member.bulbId.groupId);
+    stream.write(static_cast<uint8_t>(member.bulbId.deviceType));
+    stream.write(member.state.fields);
+    stream.write(static_cast<uint8_t>(member.state.status));
+    stream.write(member.state.level);
+    writeUint16(stream, member.state.hue);
+    stream.write(member.state.saturation);
+    stream.write(member.state.kelvin);
+    stream.write(member.state.mode);
+  }
+}
+
+void Scene::serialize(JsonObject json) const {
+  json[F("id")] = id;
+  json[F("name")] = name;
+
+  JsonArray jsonMembers = json.createNestedArray(F("members"));
+
+  for (const SceneMember& member : members) {
+    JsonObject jsonMember = jsonMembers.createNestedObject();
+
+    jsonMember[GroupStateFieldNames::DEVICE_ID] = member.bulbId.deviceId;
+    jsonMember[GroupStateFieldNames::GROUP_ID] = member.bulbId.groupId;
+    jsonMember[GroupStateFieldNames::DEVICE_TYPE] = MiLightRemoteTypeHelpers::remoteTypeToString(member.bulbId.deviceType);
+    member.state.serialize(jsonMember);
+  }
+}
+
+void Scene::loadScenes(Stream& stream, std::map<uint16_t, Scene>& scenes) {
+  uint8_t header[4];
+
+  if (stream.readBytes(header, sizeof(header)) != sizeof(header)
+    || header[0] != SCENE_FILE_MAGIC[0]
+    || header[1] != SCENE_FILE_MAGIC[1]) {
+    Serial.println(F("ERROR: scene file invalid. bad header"));
+    return;
+  }
+
+  if (header[2] != SCENE_FILE_VERSION) {
+    Serial.printf_P(PSTR("ERROR: unsupported scene file version %d\n"), header[2]);
+    return;
+  }
+
+  const uint8_t numScenes = header[3];
+  Serial.printf_P(PSTR("Reading %d scenes\n"), numScenes);
+
+  for (size_t i = 0; i < numScenes; ++i) {
+    Scene scene;
+
+    if (! scene.load(stream)) {
+      return;
+    }
+
+    scenes[scene.id] = scene;
+  }
+}
+
+void Scene::saveScenes(Stream& stream, const std::map<uint16_t, Scene>& scenes) {
+  const uint8_t numScenes = std::min(scenes.size(), static_cast<size_t>(MILIGHT_MAX_SCENES));
+
+  stream.write(SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC));
+  stream.write(SCENE_FILE_VERSION);
+  stream.write(numScenes);
+
+  Serial.printf_P(PSTR("Saving %d scenes\n"), numScenes);
+
+  auto it = scenes.begin();
+  for (size_t i = 0; i < numScenes; ++i, ++it) {
+    it->second.dump(stream);
+  }
+}
@@ -0,0 +1,86 @@
+#include <Arduino.h>
+#include <Stream.h>
+#include <ArduinoJson.h>
+#include <BulbId.h>
+#include <GroupState.h>
+#include <StateUpdate.h>
+
+#include <map>
+#include <vector>
+
+#ifndef _SCENE_H
+#define _SCENE_H
+
+#define MAX_SCENE_NAME_LEN 32
+
+#ifndef MILIGHT_MAX_SCENES
+#define MILIGHT_MAX_SCENES 32
+#endif
+
+#ifndef MILIGHT_MAX_SCENE_MEMBERS
+#define MILIGHT_MAX_SCENE_MEMBERS 64
+#endif
+
+/*
+ * Target state for one bulb in a scene.  Only the fields flagged in `fields` are
+ * applied.  Which of hue, kelvin, white mode, mode or night mode is set determines
+ * the bulb mode.
+ */
+struct SceneState {
+  enum Field : uint8_t {
+    STATUS     = 1 << 0,
+    LEVEL      = 1 << 1,
+    HUE        = 1 << 2,
+    SATURATION = 1 << 3,
+    KELVIN     = 1 << 4,
+    MODE       = 1 << 5,
+    NIGHT_MODE = 1 << 6,
+    // White without a known temperature, e.g. on RGBW bulbs
+    WHITE_MODE = 1 << 7
+  };
+
+  uint8_t fields;
+  MiLightStatus status;
+  // Brightness in [0, 100]
+  uint8_t level;
+  uint16_t hue;
+  uint8_t saturation;
+  // White temperature in [0, 100]
+  uint8_t kelvin;
+  uint8_t mode;
+
+  SceneState();
+
+  inline bool has(Field field) const { return (fields & field) != 0; }
+
+  static SceneState fromUpdate(const StateUpdate& update);
+  static SceneState fromGroupState(const GroupState& state);
+
+  void serialize(JsonObject json) const;
+};
+
+struct SceneMember {
+  BulbId bulbId;
+  SceneState state;
+};
+
+struct Scene {
+  uint16_t id;
+  char name[MAX_SCENE_NAME_LEN + 1];
+  std::vector<SceneMember> members;
+
+  Scene();
+
+  void setName(const char* name);
+
+  // Binary format, see Scene.cpp
+  bool load(Stream& stream);
+  void dump(Stream& stream) const;
+
+  void serialize(JsonObject json) const;
+
+  static void loadScenes(Stream& stream, std::map<uint16_t, Scene>& scenes);
+  static void saveScenes(Stream& stream, const std::map<uint16_t, Scene>& scenes);
+};
+
+#endif
@@ -0,0 +1,269 @@
+#include <SceneController.h>
+#include <ProjectFS.h>
+#include <StreamUtils.h>
+#include <algorithm>
+
+SceneController::SceneController(MiLightClient*& milightClient, PacketSender*& packetSender, GroupStateStore*& stateStore)
+  : milightClient(milightClient)
+  , packetSender(packetSender)
+  , stateStore(stateStore)
+  , nextId(1)
+  , nextPhase(0)
+  , nextMember(0)
+{ }
+
+void SceneController::load() {
+  scenes.clear();
+
+  if (ProjectFS.exists(SCENES_FILE)) {
+    File f = ProjectFS.open(SCENES_FILE, "r");
+    ReadBufferingStream reader{f, 64};
+    Scene::loadScenes(reader, scenes);
+    f.close();
+  }
+
+  nextId = scenes.empty() ? 1 : scenes.rbegin()->first + 1;
+}
+
+void SceneController::save() {
+  File f = ProjectFS.open(SCENES_FILE, "w");
+
+  if (!f) {
+    Serial.println(F("Opening scenes file failed"));
+    return;
+  }
+
+  WriteBufferingStream writer{f, 64};
+  Scene::saveScenes(writer, scenes);
+  writer.flush();
+  f.close();
+}
+
+const std::map<uint16_t, Scene>& SceneController::getScenes() const {
+  return scenes;
+}
+
+const Scene* SceneController::get(uint16_t id) const {
+  auto it = scenes.find(id);
+  return it == scenes.end() ? NULL : &it->second;
+}
+
+const Scene* SceneController::findByName(const char* name) const {
+  for (auto& scene : scenes) {
+    if (0 == strcmp(scene.second.name, name)) {
+      return &scene.second;
+    }
+  }
+  return NULL;
+}
+
+bool SceneController::add(Scene& scene) {
+  if (scenes.size() >= MILIGHT_MAX_SCENES || nextId == 0) {
+    return false;
+  }
+
+  scene.id = nextId++;
+  scenes[scene.id] = scene;
+
+  return true;
+}
+
+bool SceneController::remove(uint16_t id) {
+  return scenes.erase(id) > 0;
+}
+
+size_t SceneController::activate(const Scene& scene) {
+  activeScene = scene;
+
+  if (activeScene.members.size() > MILIGHT_MAX_SCENE_MEMBERS) {
+    activeScene.members.resize(MILIGHT_MAX_SCENE_MEMBERS);
+  }
+
+  size_t numPlanned = 0;
+
+  // Plan everything up front.  State is only updated as packets go out, which would
+  // otherwise make later members' plans depend on how far the queue has drained.
+  for (size_t i = 0; i < activeScene.members.size(); ++i) {
+    const SceneMember& member = activeScene.members[i];
+    const MiLightRemoteConfig* config = MiLightRemoteConfig::fromType(member.bulbId.deviceType);
+
+    plans[i] = config == NULL ? 0 : planMember(member, stateStore->get(member.bulbId));
+
+    for (uint8_t phases = plans[i]; phases != 0; phases &= phases - 1) {
+      numPlanned++;
+    }
+  }
+
+  nextPhase = numPlanned > 0 ? PHASE_ON : 0;
+  nextMember = 0;
+  pending.clear();
+
+  loop();
+
+  return numPlanned;
+}
+
+void SceneController::loop() {
+  while (!pending.isEmpty() || buildNext()) {
+    // Commands that step a value up or down can take many packets.  Wait until all of
+    // them fit rather than block in enqueue.
+    if (!packetSender->hasRoomFor(pending.numPackets())) {
+      return;
+    }
+
+    packetSender->enqueue(pending);
+  }
+}
+
+bool SceneController::buildNext() {
+  while (nextPhase != 0) {
+    if (nextMember >= activeScene.members.size()) {
+      nextMember = 0;
+      nextPhase <<= 1;
+
+#ifdef DEBUG_PRINTF
+      if (nextPhase == 0) {
+        Serial.printf_P(PSTR("Finished activating scene %u\n"), activeScene.id);
+      }
+#endif
+      continue;
+    }
+
+    const size_t i = nextMember++;
+
+    if ((plans[i] & nextPhase) == 0) {
+      continue;
+    }
+
+    const SceneMember& member = activeScene.members[i];
+
+    milightClient->beginBatch(pending);
+    milightClient->prepare(MiLightRemoteConfig::fromType(member.bulbId.deviceType), member.bulbId.deviceId, member.bulbId.groupId);
+    sendPhase(nextPhase, member.state);
+    milightClient->endBatch();
+
+    if (!pending.isEmpty()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+uint8_t SceneController::planMember(const SceneMember& member, const GroupState* current) {
+  const SceneState& target = member.state;
+
+  // Off excludes everything else.  Changing other fields would turn the bulb on.
+  if (target.has(SceneState::STATUS) && target.status == OFF) {
+    const bool knownOff = current != NULL && current->isSetState() && current->getState() == OFF;
+    return knownOff ? 0 : PHASE_OFF;
+  }
+
+  // Night mode turns the bulb on and replaces any other setting
+  if (target.has(SceneState::NIGHT_MODE)) {
+    return (current != NULL && current->isNightMode()) ? 0 : PHASE_NIGHT_MODE;
+  }
+
+  const bool knownOn = current != NULL && current->isSetState() && current->isOn();
+  const bool knownMode = current != NULL && current->isSetBulbMode() && !current->isNightMode();
+  const BulbMode currentMode = knownMode ? current->getBulbMode() : BULB_MODE_NIGHT;
+  bool modeChanges = false;
+  uint8_t phases = 0;
+
+  if (target.has(SceneState::STATUS) && !knownOn) {
+    phases |= PHASE_ON;
+  }
+
+  if (target.has(SceneState::HUE)) {
+    // Hue is stored with 8 bits of precision, so only compare to within a degree
+    const bool same = currentMode == BULB_MODE_COLOR
+      && current->isSetHue()
+      && abs(static_cast<int>(current->getHue()) - static_cast<int>(target.hue)) <= 1;
+
+    if (!same) {
+      phases |= PHASE_HUE;
+      modeChanges |= currentMode != BULB_MODE_COLOR;
+    }
+  }
+
+  if (target.has(SceneState::SATURATION)) {
+    const bool same = currentMode == BULB_MODE_COLOR
+      && current->isSetSaturation()
+      && current->getSaturation() == target.saturation;
+
+    if (!same) {
+      phases |= PHASE_SATURATION;
+      modeChanges |= currentMode != BULB_MODE_COLOR;
+    }
+  }
+
+  if (target.has(SceneState::KELVIN) || target.has(SceneState::WHITE_MODE)) {
+    const bool same = currentMode == BULB_MODE_WHITE
+      && (!target.has(SceneState::KELVIN) || (current->isSetKelvin() && current->getKelvin() == target.kelvin));
+
+    if (!same) {
+      phases |= PHASE_WHITE;
+      modeChanges |= currentMode != BULB_MODE_WHITE;
+    }
+  }
+
+  if (target.has(SceneState::MODE)) {
+    const bool same = currentMode == BULB_MODE_SCENE
+      && current->isSetMode()
+      && current->getMode() == target.mode;
+
+    if (!same) {
+      phases |= PHASE_MODE;
+      modeChanges |= currentMode != BULB_MODE_SCENE;
+    }
+  }
+
+  // Brightness is tracked per bulb mode, so it has to be resent if the mode changes
+  if (target.has(SceneState::LEVEL)) {
+    const bool same = !modeChanges
+      && knownMode
+      && current->isSetBrightness()
+      && current->getBrightness() == target.level;
+
+    if (!same) {
+      phases |= PHASE_LEVEL;
+    }
+  }
+
+  return phases;
+}
+
+void SceneController::sendPhase(uint8_t phase, const SceneState& target) {
+  switch (phase) {
+    case PHASE_ON:
+      milightClient->updateStatus(ON);
+      break;
+    case PHASE_NIGHT_MODE:
+      milightClient->enableNightMode();
+      break;
+    case PHASE_HUE:
+      milightClient->updateHue(target.hue);
+      break;
+    case PHASE_SATURATION:
+      milightClient->updateSaturation(target.saturation);
+      break;
+    case PHASE_WHITE:
+      // Temperature commands don't switch RGBW bulbs to white, so send both if needed
+      if (target.has(SceneState::WHITE_MODE)) {
+        milightClient->updateColorWhite();
+      }
+      if (target.has(SceneState::KELVIN)) {
+        milightClient->updateTemperature(target.kelvin);
+      }
+      break;
+    case PHASE_MODE:
+      milightClient->updateMode(target.mode);
+      break;
+    case PHASE_LEVEL:
+      milightClient->updateBrightness(target.level);
+      break;
+    case PHASE_OFF:
+      milightClient->updateStatus(OFF);
+      break;
+  }
+}
@@ -0,0 +1,88 @@
+#include <Arduino.h>
+#include <Scene.h>
+#include <MiLightClient.h>
+#include <PacketSender.h>
+#include <GroupStateStore.h>
+
+#include <map>
+
+#ifndef _SCENE_CONTROLLER_H
+#define _SCENE_CONTROLLER_H
+
+#define SCENES_FILE "/scenes.bin"
+
+/*
+ * Stores scenes (a list of bulbs and the state each should be in) and activates them.
+ *
+ * Activation compares each member's target against GroupStateStore and only sends
+ * commands for fields that differ or aren't known.  Commands are sent one phase at a
+ * time across all members (all "on"s, then all hues, ..., then all "off"s), so bulbs
+ * change together rather than one after another.
+ *
+ * A scene can need more commands than the packet queue holds, so they're sent from
+ * loop() as the queue drains rather than all at once.
+ */
+class SceneController {
+public:
+  // Activation sends one phase at a time across every member.  The order mirrors
+  // MiLightClient::update: on first, level after the bulb mode is set, off last.
+  enum Phase : uint8_t {
+    PHASE_ON         = 1 << 0,
+    PHASE_NIGHT_MODE = 1 << 1,
+    PHASE_HUE        = 1 << 2,
+    PHASE_SATURATION = 1 << 3,
+    // White mode, and the temperature if the target has one
+    PHASE_WHITE      = 1 << 4,
+    PHASE_MODE       = 1 << 5,
+    PHASE_LEVEL      = 1 << 6,
+    PHASE_OFF        = 1 << 7
+  };
+
+  SceneController(MiLightClient*& milightClient, PacketSender*& packetSender, GroupStateStore*& stateStore);
+
+  void load();
+  void save();
+
+  const std::map<uint16_t, Scene>& getScenes() const;
+  const Scene* get(uint16_t id) const;
+  const Scene* findByName(const char* name) const;
+
+  // Assigns the scene an id and stores it.  Returns false if the store is full.
+  bool add(Scene& scene);
+  bool remove(uint16_t id);
+
+  // Plan the commands needed to bring every member to its target state, and start
+  // sending them.  Replaces any activation still in progress.  Returns the number of
+  // commands planned.
+  size_t activate(const Scene& scene);
+
+  // Send planned commands while the packet queue has room
+  void loop();
+
+  // Phases needed to bring a bulb from its current state (NULL if unknown) to the
+  // member's target
+  static uint8_t planMember(const SceneMember& member, const GroupState* current);
+
+private:
+  MiLightClient*& milightClient;
+  PacketSender*& packetSender;
+  GroupStateStore*& stateStore;
+  std::map<uint16_t, Scene> scenes;
+  uint16_t nextId;
+
+  // Activation in progress.  The scene is copied so that it can be edited or deleted
+  // meanwhile.  nextPhase is 0 when there's nothing left to send.
+  Scene activeScene;
+  uint8_t plans[MILIGHT_MAX_SCENE_MEMBERS];
+  uint8_t nextPhase;
+  size_t nextMember;
+
+  // Packets for the next command, held until the queue has room for all of them
+  PacketBatch pending;
+
+  // Build the next planned command into pending.  Returns false once there are none.
+  bool buildNext();
+  void sendPhase(uint8_t phase, const SceneState& target);
+};
+
+#endif
@@ -74,6 +74,10 @@ void Settings::patch(JsonObject parsedSettings) {
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::CE_PIN), cePin);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::CSN_PIN), csnPin);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::RESET_PIN), resetPin);
+  this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::LISTEN_CE_PIN), listenCePin);
+  this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::LISTEN_CSN_PIN), listenCsnPin);
+  this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::LISTEN_RESET_PIN), listenResetPin);
+  this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::RADIO_IRQ_PIN), radioIrqPin);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::LED_PIN), ledPin);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::PACKET_REPEATS), packetRepeats);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::HTTP_REPEAT_FACTOR), httpRepeatFactor);
@@ -85,6 +89,7 @@ void Settings::patch(JsonObject parsedSettings) {
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::MQTT_UPDATE_TOPIC_PATTERN), mqttUpdateTopicPattern);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::MQTT_STATE_TOPIC_PATTERN), mqttStateTopicPattern);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::MQTT_CLIENT_STATUS_TOPIC), mqttClientStatusTopic);
+  this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::MQTT_SCENE_TOPIC), mqttSceneTopic);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::SIMPLE_MQTT_CLIENT_STATUS), simpleMqttClientStatus);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::DISCOVERY_PORT), discoveryPort);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::LISTEN_REPEATS), listenRepeats);
@@ -95,7 +100,10 @@ void Settings::patch(JsonObject parsedSettings) {
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::PACKET_REPEAT_THROTTLE_THRESHOLD), packetRepeatThrottleThreshold);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::PACKET_REPEAT_THROTTLE_SENSITIVITY), packetRepeatThrottleSensitivity);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::PACKET_REPEAT_MINIMUM), packetRepeatMinimum);
+  this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::ADAPTIVE_PACKET_REPEATS), adaptivePacketRepeats);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::ENABLE_AUTOMATIC_MODE_SWITCHING), enableAutomaticModeSwitching);
+  this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::CCT_RECALIBRATE_INTERVAL), cctRecalibrateInterval);
+  this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::NOOP_SUPPRESSION_MAX_AGE), noopSuppressionMaxAge);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::LED_MODE_PACKET_COUNT), ledModePacketCount);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::HOSTNAME), hostname);
   this->setIfPresent(parsedSettings, FPSTR(SettingsKeys::WIFI_STATIC_IP), wifiStaticIP);
@@ -142,6 +150,12 @@ void Settings::patch(JsonObject parsedSettings) {
     this->radioInterfaceType = Settings::typeFromString(parsedSettings[FPSTR(SettingsKeys::RADIO_INTERFACE_TYPE)]);
   }
 
+  if (parsedSettings.containsKey(FPSTR(SettingsKeys::LISTEN_RADIO_INTERFACE_TYPE))) {
+    String listenType = parsedSettings[FPSTR(SettingsKeys::LISTEN_RADIO_INTERFACE_TYPE)];
+    this->listenRadioEnabled = listenType.length() > 0 && !listenType.equalsIgnoreCase("none");
+    this->listenRadioInterfaceType = Settings::typeFromString(listenType);
+  }
+
   if (parsedSettings.containsKey(FPSTR(SettingsKeys::DEVICE_IDS))) {
     JsonArray arr = parsedSettings[FPSTR(SettingsKeys::DEVICE_IDS)];
     updateDeviceIds(arr);
@@ -315,6 +329,11 @@ void Settings::serialize(Print& stream, const bool prettyPrint) const {
   root[FPSTR(SettingsKeys::RESET_PIN)] = this->resetPin;
   root[FPSTR(SettingsKeys::LED_PIN)] = this->ledPin;
   root[FPSTR(SettingsKeys::RADIO_INTERFACE_TYPE)] = typeToString(this->radioInterfaceType);
+  root[FPSTR(SettingsKeys::LISTEN_RADIO_INTERFACE_TYPE)] = this->listenRadioEnabled ? typeToString(this->listenRadioInterfaceType) : "none";
+  root[FPSTR(SettingsKeys::LISTEN_CE_PIN)] = this->listenCePin;
+  root[FPSTR(SettingsKeys::LISTEN_CSN_PIN)] = this->listenCsnPin;
+  root[FPSTR(SettingsKeys::LISTEN_RESET_PIN)] = this->listenResetPin;
+  root[FPSTR(SettingsKeys::RADIO_IRQ_PIN)] = this->radioIrqPin;
   root[FPSTR(SettingsKeys::PACKET_REPEATS)] = this->packetRepeats;
   root[FPSTR(SettingsKeys::HTTP_REPEAT_FACTOR)] = this->httpRepeatFactor;
   root[FPSTR(SettingsKeys::AUTO_RESTART_PERIOD)] = this->_autoRestartPeriod;
@@ -325,6 +344,7 @@ void Settings::serialize(Print& stream, const bool prettyPrint) const {
   root[FPSTR(SettingsKeys::MQTT_UPDATE_TOPIC_PATTERN)] = this->mqttUpdateTopicPattern;
   root[FPSTR(SettingsKeys::MQTT_STATE_TOPIC_PATTERN)] = this->mqttStateTopicPattern;
   root[FPSTR(SettingsKeys::MQTT_CLIENT_STATUS_TOPIC)] = this->mqttClientStatusTopic;
+  root[FPSTR(SettingsKeys::MQTT_SCENE_TOPIC)] = this->mqttSceneTopic;
   root[FPSTR(SettingsKeys::SIMPLE_MQTT_CLIENT_STATUS)] = this->simpleMqttClientStatus;
   root[FPSTR(SettingsKeys::DISCOVERY_PORT)] = this->discoveryPort;
   root[FPSTR(SettingsKeys::LISTEN_REPEATS)] = this->listenRepeats;
@@ -335,7 +355,10 @@ void Settings::serialize(Print& stream, const bool prettyPrint) const {
   root[FPSTR(SettingsKeys::PACKET_REPEAT_THROTTLE_SENSITIVITY)] = this->packetRepeatThrottleSensitivity;
   root[FPSTR(SettingsKeys::PACKET_REPEAT_THROTTLE_THRESHOLD)] = this->packetRepeatThrottleThreshold;
   root[FPSTR(SettingsKeys::PACKET_REPEAT_MINIMUM)] = this->packetRepeatMinimum;
+  root[FPSTR(SettingsKeys::ADAPTIVE_PACKET_REPEATS)] = this->adaptivePacketRepeats;
   root[FPSTR(SettingsKeys::ENABLE_AUTOMATIC_MODE_SWITCHING)] = this->enableAutomaticModeSwitching;
+  root[FPSTR(SettingsKeys::CCT_RECALIBRATE_INTERVAL)] = this->cctRecalibrateInterval;
+  root[FPSTR(SettingsKeys::NOOP_SUPPRESSION_MAX_AGE)] = this->noopSuppressionMaxAge;
   root[FPSTR(SettingsKeys::LED_MODE_WIFI_CONFIG)] = LEDStatus::LEDModeToString(this->ledModeWifiConfig);
   root[FPSTR(SettingsKeys::LED_MODE_WIFI_FAILED)] = LEDStatus::LEDModeToString(this->ledModeWifiFailed);
   root[FPSTR(SettingsKeys::LED_MODE_OPERATING)] = LEDStatus::LEDModeToString(this->ledModeOperating);
@@ -104,6 +104,7 @@ namespace SettingsKeys {
   static const char MQTT_UPDATE_TOPIC_PATTERN[] PROGMEM = "mqtt_update_topic_pattern";
   static const char MQTT_STATE_TOPIC_PATTERN[] PROGMEM = "mqtt_state_topic_pattern";
   static const char MQTT_CLIENT_STATUS_TOPIC[] PROGMEM = "mqtt_client_status_topic";
+  static const char MQTT_SCENE_TOPIC[] PROGMEM = "mqtt_scene_topic";
   static const char SIMPLE_MQTT_CLIENT_STATUS[] PROGMEM = "simple_mqtt_client_status";
   static const char DISCOVERY_PORT[] PROGMEM = "discovery_port";
   static const char LISTEN_REPEATS[] PROGMEM = "listen_repeats";
@@ -114,7 +115,10 @@ namespace SettingsKeys {
   static const char PACKET_REPEAT_THROTTLE_THRESHOLD[] PROGMEM = "packet_repeat_throttle_threshold";
   static const char PACKET_REPEAT_THROTTLE_SENSITIVITY[] PROGMEM = "packet_repeat_throttle_sensitivity";
   static const char PACKET_REPEAT_MINIMUM[] PROGMEM = "packet_repeat_minimum";
+  static const char ADAPTIVE_PACKET_REPEATS[] PROGMEM = "adaptive_packet_repeats";
   static const char ENABLE_AUTOMATIC_MODE_SWITCHING[] PROGMEM = "enable_automatic_mode_switching";
+  static const char CCT_RECALIBRATE_INTERVAL[] PROGMEM = "cct_recalibrate_interval";
+  static const char NOOP_SUPPRESSION_MAX_AGE[] PROGMEM = "noop_suppression_max_age";
   static const char LED_MODE_PACKET_COUNT[] PROGMEM = "led_mode_packet_count";
   static const char HOSTNAME[] PROGMEM = "hostname";
   static const char WIFI_STATIC_IP[] PROGMEM = "wifi_static_ip";
@@ -132,6 +136,11 @@ namespace SettingsKeys {
   static const char LED_MODE_OPERATING[] PROGMEM = "led_mode_operating";
   static const char LED_MODE_PACKET[] PROGMEM = "led_mode_packet";
   static const char RADIO_INTERFACE_TYPE[] PROGMEM = "radio_interface_type";
+  static const char LISTEN_RADIO_INTERFACE_TYPE[] PROGMEM = "listen_radio_interface_type";
+  static const char LISTEN_CE_PIN[] PROGMEM = "listen_ce_pin";
+  static const char LISTEN_CSN_PIN[] PROGMEM = "listen_csn_pin";
+  static const char LISTEN_RESET_PIN[] PROGMEM = "listen_reset_pin";
+  static const char RADIO_IRQ_PIN[] PROGMEM = "radio_irq_pin";
   static const char DEVICE_IDS[] PROGMEM = "device_ids";
   static const char GATEWAY_CONFIGS[] PROGMEM = "gateway_configs";
   static const char GROUP_STATE_FIELDS[] PROGMEM = "group_state_fields";
@@ -150,6 +159,12 @@ public:
     resetPin(0),
     ledPin(-2),
     radioInterfaceType(nRF24),
+    listenRadioEnabled(false),
+    listenRadioInterfaceType(nRF24),
+    listenCePin(16),
+    listenCsnPin(15),
+    listenResetPin(0),
+    radioIrqPin(-1),
     packetRepeats(50),
     httpRepeatFactor(1),
     listenRepeats(3),
@@ -162,7 +177,10 @@ public:
     packetRepeatThrottleThreshold(200),
     packetRepeatThrottleSensitivity(0),
     packetRepeatMinimum(3),
+    adaptivePacketRepeats(false),
     enableAutomaticModeSwitching(false),
+    cctRecalibrateInterval(0),
+    noopSuppressionMaxAge(0),
     ledModeWifiConfig(LEDStatus::LEDMode::FastToggle),
     ledModeWifiFailed(LEDStatus::LEDMode::On),
     ledModeOperating(LEDStatus::LEDMode::SlowBlip),
@@ -215,6 +233,18 @@ public:
   uint8_t resetPin;
   int8_t ledPin;
   RadioInterfaceType radioInterfaceType;
+
+  // Optional second radio module dedicated to listening
+  bool listenRadioEnabled;
+  RadioInterfaceType listenRadioInterfaceType;
+  uint8_t listenCePin;
+  uint8_t listenCsnPin;
+  uint8_t listenResetPin;
+
+  // IRQ (nRF24) or PKT_FLAG (LT8900) pin of the radio used to receive.  Negative
+  // to poll instead.
+  int8_t radioIrqPin;
+
   size_t packetRepeats;
   size_t httpRepeatFactor;
   uint8_t listenRepeats;
@@ -226,6 +256,7 @@ public:
   String mqttUpdateTopicPattern;
   String mqttStateTopicPattern;
   String mqttClientStatusTopic;
+  String mqttSceneTopic;
   bool simpleMqttClientStatus;
   size_t stateFlushInterval;
   size_t mqttStateRateLimit;
@@ -234,7 +265,14 @@ public:
   size_t packetRepeatThrottleThreshold;
   size_t packetRepeatThrottleSensitivity;
   size_t packetRepeatMinimum;
+  bool adaptivePacketRepeats;
   bool enableAutomaticModeSwitching;
+  // Minutes after which the position of a CCT bulb that's off is recalibrated.  0 to
+  // disable.
+  uint16_t cctRecalibrateInterval;
+  // Seconds for which state confirmed by a packet is trusted enough to skip commands
+  // that wouldn't change it.  0 to disable.
+  uint16_t noopSuppressionMaxAge;
   LEDStatus::LEDMode ledModeWifiConfig;
   LEDStatus::LEDMode ledModeWifiFailed;
   LEDStatus::LEDMode ledModeOperating;
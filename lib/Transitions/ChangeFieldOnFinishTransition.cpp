@@ -30,13 +30,27 @@ ChangeFieldOnFinishTransition::ChangeFieldOnFinishTransition(
   GroupStateField field,
   uint16_t arg,
   size_t period
-) : Transition(delegate->id, delegate->bulbId, period, delegate->callback)
+) : Transition(delegate->id, delegate->bulbId, period, delegate->getCallback())
   , delegate(delegate)
   , field(field)
   , arg(arg)
   , changeSent(false)
 { }
 
+void ChangeFieldOnFinishTransition::setCallback(TransitionFn callback) {
+  delegate->setCallback(callback);
+  Transition::setCallback(std::move(callback));
+}
+
+size_t ChangeFieldOnFinishTransition::getPacketsPerStep() const {
+  return delegate->getPacketsPerStep();
+}
+
+void ChangeFieldOnFinishTransition::setStride(size_t stride) {
+  delegate->setStride(stride);
+  Transition::setStride(stride);
+}
+
 bool ChangeFieldOnFinishTransition::isFinished() {
   return delegate->isFinished() && changeSent;
 }
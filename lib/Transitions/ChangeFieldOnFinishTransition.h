@@ -25,6 +25,9 @@ public:
   );
 
   virtual bool isFinished() override;
+  virtual void setCallback(TransitionFn callback) override;
+  virtual size_t getPacketsPerStep() const override;
+  virtual void setStride(size_t stride) override;
 
 private:
   std::shared_ptr<Transition> delegate;
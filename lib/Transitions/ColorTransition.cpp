@@ -83,8 +83,12 @@ size_t ColorTransition::calculateColorPeriod(ColorTransition* t, const RgbColor&
 }
 
 int16_t ColorTransition::calculateStepSizePart(int16_t distance, size_t duration, size_t period) {
-  double stepSize = (distance / static_cast<double>(duration)) * period;
-  int16_t rounded = std::ceil(std::abs(stepSize));
+  if (duration == 0) {
+    return distance;
+  }
+
+  // ceil(|distance| / duration * period)
+  int16_t rounded = (static_cast<size_t>(std::abs(distance)) * period + duration - 1) / duration;
 
   if (distance < 0) {
     rounded *= -1;
@@ -107,14 +111,20 @@ void ColorTransition::step() {
   }
 
   if (!isFinished()) {
-    Transition::stepValue(currentColor.r, endColor.r, stepSizes.r);
-    Transition::stepValue(currentColor.g, endColor.g, stepSizes.g);
-    Transition::stepValue(currentColor.b, endColor.b, stepSizes.b);
+    const int16_t multiplier = stride;
+    Transition::stepValue(currentColor.r, endColor.r, stepSizes.r * multiplier);
+    Transition::stepValue(currentColor.g, endColor.g, stepSizes.g * multiplier);
+    Transition::stepValue(currentColor.b, endColor.b, stepSizes.b * multiplier);
   } else {
     this->sentFinalColor = true;
   }
 }
 
+size_t ColorTransition::getPacketsPerStep() const {
+  // Hue and saturation
+  return 2;
+}
+
 bool ColorTransition::isFinished() {
   return this->sentFinalColor;
 }
@@ -40,6 +40,7 @@ public:
   inline static size_t calculateMaxDistance(const RgbColor& start, const RgbColor& end);
   inline static int16_t calculateStepSizePart(int16_t distance, size_t duration, size_t period);
   virtual bool isFinished() override;
+  virtual size_t getPacketsPerStep() const override;
 
 protected:
   const RgbColor endColor;
@@ -66,7 +66,7 @@ void FieldTransition::step() {
   callback(bulbId, field, currentValue);
 
   if (currentValue != endValue) {
-    Transition::stepValue(currentValue, endValue, stepSize);
+    Transition::stepValue(currentValue, endValue, stepSize * static_cast<int16_t>(stride));
   } else {
     finished = true;
   }
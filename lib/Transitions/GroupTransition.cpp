@@ -0,0 +1,67 @@
+#include <GroupTransition.h>
+
+GroupTransition::Builder::Builder(
+  const std::vector<BulbId>& members,
+  std::shared_ptr<Transition::Builder> delegate
+)
+  : Transition::Builder(delegate->id, delegate->defaultPeriod, delegate->bulbId, delegate->callback, delegate->getMaxSteps())
+  , delegate(delegate)
+  , members(members)
+{ }
+
+std::shared_ptr<Transition> GroupTransition::Builder::_build() const {
+  delegate->setDurationRaw(this->getOrComputeDuration());
+  delegate->setPeriod(this->getOrComputePeriod());
+
+  return std::make_shared<GroupTransition>(
+    delegate->build(),
+    members,
+    delegate->getPeriod()
+  );
+}
+
+GroupTransition::GroupTransition(
+  std::shared_ptr<Transition> delegate,
+  const std::vector<BulbId>& members,
+  size_t period
+) : Transition(delegate->id, delegate->bulbId, period, delegate->getCallback())
+  , delegate(delegate)
+  , members(members)
+{
+  // The delegate steps as if for one bulb.  Fan each value it produces out to everyone.
+  delegate->setCallback([this](const BulbId&, GroupStateField field, uint16_t value) {
+    for (const BulbId& member : this->members) {
+      callback(member, field, value);
+    }
+  });
+}
+
+size_t GroupTransition::getPacketsPerStep() const {
+  return members.size() * delegate->getPacketsPerStep();
+}
+
+void GroupTransition::setStride(size_t stride) {
+  delegate->setStride(stride);
+  Transition::setStride(stride);
+}
+
+bool GroupTransition::isFinished() {
+  return delegate->isFinished();
+}
+
+void GroupTransition::step() {
+  delegate->step();
+}
+
+void GroupTransition::childSerialize(JsonObject& json) {
+  json[F("type")] = F("group");
+
+  JsonArray bulbs = json.createNestedArray(F("bulbs"));
+  for (const BulbId& member : members) {
+    JsonObject bulb = bulbs.createNestedObject();
+    member.serialize(bulb);
+  }
+
+  JsonObject child = json.createNestedObject(F("child"));
+  delegate->childSerialize(child);
+}
@@ -0,0 +1,40 @@
+#include <Transition.h>
+#include <vector>
+
+#pragma once
+
+/*
+ * Runs one transition for several bulbs.  Each step of the delegate is sent to every
+ * member before the next field, so all members change together on one schedule.
+ */
+class GroupTransition : public Transition {
+public:
+
+  class Builder : public Transition::Builder {
+  public:
+    Builder(const std::vector<BulbId>& members, std::shared_ptr<Transition::Builder> delegate);
+
+    virtual std::shared_ptr<Transition> _build() const override;
+
+  private:
+    const std::shared_ptr<Transition::Builder> delegate;
+    const std::vector<BulbId> members;
+  };
+
+  GroupTransition(
+    std::shared_ptr<Transition> delegate,
+    const std::vector<BulbId>& members,
+    size_t period
+  );
+
+  virtual bool isFinished() override;
+  virtual size_t getPacketsPerStep() const override;
+  virtual void setStride(size_t stride) override;
+
+private:
+  std::shared_ptr<Transition> delegate;
+  const std::vector<BulbId> members;
+
+  virtual void step() override;
+  virtual void childSerialize(JsonObject& json) override;
+};
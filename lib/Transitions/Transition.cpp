@@ -1,6 +1,7 @@
 #include <Transition.h>
 #include <Arduino.h>
 #include <cmath>
+#include <algorithm>
 
 // transition commands are in seconds, convert to ms.
 const uint16_t Transition::DURATION_UNIT_MULTIPLIER = 1000;
@@ -130,7 +131,10 @@ std::shared_ptr<Transition> Transition::Builder::build() {
     }
   }
 
-  return _build();
+  std::shared_ptr<Transition> transition = _build();
+  transition->setPlannedDuration(getOrComputeDuration());
+
+  return transition;
 }
 
 Transition::Transition(
@@ -143,17 +147,54 @@ Transition::Transition(
   , callback(callback)
   , period(period)
   , lastSent(0)
+  , stride(1)
+  , plannedDuration(0)
+  , startedAt(0)
 { }
 
-void Transition::tick() {
-  unsigned long now = millis();
+void Transition::tick(unsigned long now) {
+  if (lastSent == 0) {
+    startedAt = now;
+  }
 
-  if ((lastSent + period) <= now
-    && ((!isFinished() || lastSent == 0))) { // always send at least once
+  step();
+  lastSent = now;
+}
 
-    step();
-    lastSent = now;
-  }
+size_t Transition::getPeriod() const {
+  return period;
+}
+
+size_t Transition::getPacketsPerStep() const {
+  return 1;
+}
+
+void Transition::setStride(size_t stride) {
+  this->stride = std::max(stride, static_cast<size_t>(1));
+}
+
+size_t Transition::getStride() const {
+  return stride;
+}
+
+void Transition::setPlannedDuration(size_t duration) {
+  plannedDuration = duration;
+}
+
+size_t Transition::getPlannedDuration() const {
+  return plannedDuration;
+}
+
+unsigned long Transition::getStartedAt() const {
+  return startedAt;
+}
+
+void Transition::setCallback(TransitionFn callback) {
+  this->callback = std::move(callback);
+}
+
+const Transition::TransitionFn& Transition::getCallback() const {
+  return callback;
 }
 
 size_t Transition::calculatePeriod(int16_t distance, size_t stepSize, size_t duration) {
@@ -178,6 +219,9 @@ void Transition::serialize(JsonObject& json) {
   json[F("id")] = id;
   json[F("period")] = period;
   json[F("last_sent")] = lastSent;
+  json[F("started_at")] = startedAt;
+  json[F("planned_duration")] = plannedDuration;
+  json[F("stride")] = stride;
 
   JsonObject bulbParams = json.createNestedObject("bulb");
   bulbId.serialize(bulbParams);
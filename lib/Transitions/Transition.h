@@ -73,7 +73,6 @@ public:
 
   const size_t id;
   const BulbId bulbId;
-  const TransitionFn callback;
 
   Transition(
     size_t id,
@@ -82,17 +81,41 @@ public:
     TransitionFn callback
   );
 
-  void tick();
+  // Send the next step.  Scheduling is up to TransitionController.
+  void tick(unsigned long now);
+  size_t getPeriod() const;
+
+  // Number of packets each step sends
+  virtual size_t getPacketsPerStep() const;
+  // Advance this many steps' worth of change per step sent.  Used to send fewer, larger
+  // steps when the radio can't keep up, without finishing later than planned.
+  virtual void setStride(size_t stride);
+  size_t getStride() const;
+
+  // Duration the transition was built with, and when its first step was sent (0 if not
+  // yet started)
+  void setPlannedDuration(size_t duration);
+  size_t getPlannedDuration() const;
+  unsigned long getStartedAt() const;
+
   virtual bool isFinished() = 0;
   void serialize(JsonObject& doc);
   virtual void step() = 0;
   virtual void childSerialize(JsonObject& doc) = 0;
 
+  // Redirect where steps are sent.  Used by transitions that wrap others.
+  virtual void setCallback(TransitionFn callback);
+  const TransitionFn& getCallback() const;
+
   static size_t calculatePeriod(int16_t distance, size_t stepSize, size_t duration);
 
 protected:
+  TransitionFn callback;
   const size_t period;
   unsigned long lastSent;
+  size_t stride;
+  size_t plannedDuration;
+  unsigned long startedAt;
 
   static void stepValue(int16_t& current, int16_t end, int16_t stepSize);
 };
\ No newline at end of file
@@ -2,25 +2,50 @@
 #include <FieldTransition.h>
 #include <ColorTransition.h>
 #include <ChangeFieldOnFinishTransition.h>
+#include <GroupTransition.h>
 #include <GroupStateField.h>
 #include <MiLightStatus.h>
 
 #include <TransitionController.h>
-#include <LinkedList.h>
+#include <algorithm>
 #include <functional>
 
 using namespace std::placeholders;
 
+// Comparisons go through the difference so they survive millis() wrapping
+static bool isDue(unsigned long dueAt, unsigned long now) {
+  return static_cast<long>(now - dueAt) >= 0;
+}
+
+// Heap comparator.  std heaps put the greatest element first, so "greater" is earlier.
+static bool isDueLater(const TransitionController::ScheduledTransition& a, const TransitionController::ScheduledTransition& b) {
+  return static_cast<long>(a.dueAt - b.dueAt) > 0;
+}
+
 TransitionController::TransitionController()
   : callback(std::bind(&TransitionController::transitionCallback, this, _1, _2, _3))
+  , sink(nullptr)
   , currentId(0)
   , defaultPeriod(500)
+  , lastLag(0)
+  , maxLag(0)
+  , numSteps(0)
+  , airtimeSource(nullptr)
+  , demand(0)
+  , stride(1)
+  , lastPlannedDuration(0)
+  , lastActualDuration(0)
+  , numCompleted(0)
 { }
 
 void TransitionController::setDefaultPeriod(uint16_t defaultPeriod) {
   this->defaultPeriod = defaultPeriod;
 }
 
+void TransitionController::setAirtimeSource(AirtimeFn airtimeSource) {
+  this->airtimeSource = airtimeSource;
+}
+
 void TransitionController::clearListeners() {
   observers.clear();
 }
@@ -29,6 +54,10 @@ void TransitionController::addListener(Transition::TransitionFn fn) {
   observers.push_back(fn);
 }
 
+void TransitionController::setSink(TransitionSink* sink) {
+  this->sink = sink;
+}
+
 std::shared_ptr<Transition::Builder> TransitionController::buildColorTransition(const BulbId& bulbId, const ParsedColor& start, const ParsedColor& end) {
   return std::make_shared<ColorTransition::Builder>(
     currentId++,
@@ -72,71 +101,204 @@ std::shared_ptr<Transition::Builder> TransitionController::buildStatusTransition
   return transition;
 }
 
+std::shared_ptr<Transition::Builder> TransitionController::buildStatusTransition(const std::vector<BulbId>& members, MiLightStatus status, uint8_t startLevel) {
+  std::shared_ptr<Transition::Builder> transition = buildStatusTransition(members.front(), status, startLevel);
+
+  if (members.size() == 1) {
+    return transition;
+  }
+
+  // The single bulb builder turned on the first member
+  if (status == ON) {
+    for (size_t i = 1; i < members.size(); ++i) {
+      callback(members[i], GroupStateField::STATUS, ON);
+    }
+  }
+
+  return buildGroupTransition(members, transition);
+}
+
+std::shared_ptr<Transition::Builder> TransitionController::buildGroupTransition(const std::vector<BulbId>& members, std::shared_ptr<Transition::Builder> delegate) {
+  return std::make_shared<GroupTransition::Builder>(members, delegate);
+}
+
 void TransitionController::addTransition(std::shared_ptr<Transition> transition) {
-  activeTransitions.add(transition);
+  // First step is due immediately
+  schedule.push_back({millis(), transition});
+  std::push_heap(schedule.begin(), schedule.end(), isDueLater);
+
+  demand += packetRate(*transition);
+  updateStride();
+}
+
+uint32_t TransitionController::packetRate(const Transition& transition) {
+  return transition.getPacketsPerStep() * 1000000UL / std::max(transition.getPeriod(), static_cast<size_t>(1));
+}
+
+void TransitionController::removeDemand(const Transition& transition) {
+  demand -= std::min(demand, packetRate(transition));
+  updateStride();
+}
+
+uint32_t TransitionController::computeBudget() const {
+  const uint32_t airtime = airtimeSource ? airtimeSource() : 0;
+
+  if (airtime == 0) {
+    return 0;
+  }
+
+  // Packets per 1000 seconds
+  const uint64_t budget = static_cast<uint64_t>(MILIGHT_TRANSITION_AIRTIME_SHARE) * 10000000ULL / airtime;
+  return std::min(budget, static_cast<uint64_t>(UINT32_MAX));
+}
+
+void TransitionController::updateStride() {
+  const uint32_t budget = computeBudget();
+
+  if (budget == 0 || demand <= budget) {
+    stride = 1;
+  } else {
+    stride = std::min(static_cast<size_t>((demand + budget - 1) / budget), static_cast<size_t>(MILIGHT_TRANSITION_MAX_STRIDE));
+  }
 }
 
 void TransitionController::transitionCallback(const BulbId& bulbId, GroupStateField field, uint16_t arg) {
+  ++numSteps;
+
+  if (sink != nullptr) {
+    sink->applyTransitionStep(bulbId, field, arg);
+  }
+
   for (auto it = observers.begin(); it != observers.end(); ++it) {
     (*it)(bulbId, field, arg);
   }
 }
 
 void TransitionController::clear() {
-  activeTransitions.clear();
+  schedule.clear();
+  demand = 0;
+  stride = 1;
 }
 
 void TransitionController::loop() {
-  auto current = activeTransitions.getHead();
+  const unsigned long now = millis();
 
-  while (current != nullptr) {
-    auto next = current->next;
+  if (schedule.empty() || !isDue(schedule.front().dueAt, now)) {
+    return;
+  }
 
-    Transition& t = *current->data;
-    t.tick();
+  unsigned long lag = 0;
 
-    if (t.isFinished()) {
-      activeTransitions.remove(current);
-    }
+  // Airtime changes with repeat settings and link quality, so replan once per pass
+  updateStride();
 
-    current = next;
+  if (sink != nullptr) {
+    sink->beginTransitionSteps();
   }
-}
 
-ListNode<std::shared_ptr<Transition>>* TransitionController::getTransitions() {
-  return activeTransitions.getHead();
-}
+  while (!schedule.empty() && isDue(schedule.front().dueAt, now)) {
+    std::pop_heap(schedule.begin(), schedule.end(), isDueLater);
+    ScheduledTransition entry = std::move(schedule.back());
+    schedule.pop_back();
 
-ListNode<std::shared_ptr<Transition>>* TransitionController::findTransition(size_t id) {
-  auto current = getTransitions();
+    // Listeners may add transitions, so the entry is off the heap while it steps
+    lag = std::max(lag, now - entry.dueAt);
+    entry.transition->setStride(stride);
+    entry.transition->tick(now);
 
-  while (current != nullptr) {
-    if (current->data->id == id) {
-      return current;
+    if (entry.transition->isFinished()) {
+      lastPlannedDuration = entry.transition->getPlannedDuration();
+      lastActualDuration = now - entry.transition->getStartedAt();
+      ++numCompleted;
+      removeDemand(*entry.transition);
+    } else {
+      // At least 1ms out so a zero period can't spin this loop
+      entry.dueAt = now + std::max(entry.transition->getPeriod(), static_cast<size_t>(1)) * stride;
+      schedule.push_back(std::move(entry));
+      std::push_heap(schedule.begin(), schedule.end(), isDueLater);
     }
-    current = current->next;
   }
 
-  return nullptr;
+  if (sink != nullptr) {
+    sink->endTransitionSteps();
+  }
+
+  lastLag = lag;
+  maxLag = std::max(maxLag, lag);
+}
+
+const std::vector<TransitionController::ScheduledTransition>& TransitionController::getTransitions() const {
+  return schedule;
+}
+
+std::vector<TransitionController::ScheduledTransition>::iterator TransitionController::findTransition(size_t id) {
+  return std::find_if(
+    schedule.begin(),
+    schedule.end(),
+    [id](const ScheduledTransition& entry) { return entry.transition->id == id; }
+  );
 }
 
 Transition* TransitionController::getTransition(size_t id) {
-  auto node = findTransition(id);
+  auto it = findTransition(id);
 
-  if (node == nullptr) {
+  if (it == schedule.end()) {
     return nullptr;
   } else {
-    return node->data.get();
+    return it->transition.get();
   }
 }
 
 bool TransitionController::deleteTransition(size_t id) {
-  auto node = findTransition(id);
+  auto it = findTransition(id);
 
-  if (node == nullptr) {
+  if (it == schedule.end()) {
     return false;
   } else {
-    activeTransitions.remove(node);
+    std::shared_ptr<Transition> transition = it->transition;
+    schedule.erase(it);
+    std::make_heap(schedule.begin(), schedule.end(), isDueLater);
+    removeDemand(*transition);
     return true;
   }
+}
+
+size_t TransitionController::getNumActive() const {
+  return schedule.size();
+}
+
+size_t TransitionController::getNumSteps() const {
+  return numSteps;
+}
+
+unsigned long TransitionController::getLastLag() const {
+  return lastLag;
+}
+
+unsigned long TransitionController::getMaxLag() const {
+  return maxLag;
+}
+
+uint32_t TransitionController::getDemand() const {
+  return demand / 1000;
+}
+
+uint32_t TransitionController::getBudget() const {
+  return computeBudget() / 1000;
+}
+
+size_t TransitionController::getStride() const {
+  return stride;
+}
+
+size_t TransitionController::getLastPlannedDuration() const {
+  return lastPlannedDuration;
+}
+
+unsigned long TransitionController::getLastActualDuration() const {
+  return lastActualDuration;
+}
+
+size_t TransitionController::getNumCompleted() const {
+  return numCompleted;
 }
\ No newline at end of file
@@ -1,39 +1,113 @@
 #include <Transition.h>
-#include <LinkedList.h>
+#include <TransitionSink.h>
 #include <ParsedColor.h>
 #include <GroupStateField.h>
+#include <functional>
 #include <memory>
 #include <vector>
 
 #pragma once
 
+// Percent of the packet queue's measured throughput that transitions may use.  The
+// rest is left for commands from users and remotes.
+#ifndef MILIGHT_TRANSITION_AIRTIME_SHARE
+#define MILIGHT_TRANSITION_AIRTIME_SHARE 75
+#endif
+
+// Largest number of steps merged into one when transitions are over budget
+#ifndef MILIGHT_TRANSITION_MAX_STRIDE
+#define MILIGHT_TRANSITION_MAX_STRIDE 8
+#endif
+
+/*
+ * Active transitions are kept in a min-heap ordered by when their next step is due, so
+ * loop() only touches the ones that are due rather than every active transition.
+ *
+ * If the packets the active transitions want to send add up to more than the radio can
+ * keep up with, every transition is given the same stride: it sends every Nth step, N
+ * times further apart.  That cuts packets by N while keeping completion on schedule.
+ */
 class TransitionController {
 public:
+  struct ScheduledTransition {
+    unsigned long dueAt;
+    std::shared_ptr<Transition> transition;
+  };
+
+  // Returns the average time (us) to send one packet, or 0 if unknown
+  using AirtimeFn = std::function<uint32_t()>;
+
   TransitionController();
 
   void clearListeners();
   void addListener(Transition::TransitionFn fn);
+  // Steps go to the sink before any listeners.  Not owned.
+  void setSink(TransitionSink* sink);
   void setDefaultPeriod(uint16_t period);
+  void setAirtimeSource(AirtimeFn airtimeSource);
 
   std::shared_ptr<Transition::Builder> buildColorTransition(const BulbId& bulbId, const ParsedColor& start, const ParsedColor& end);
   std::shared_ptr<Transition::Builder> buildFieldTransition(const BulbId& bulbId, GroupStateField field, uint16_t start, uint16_t end);
   std::shared_ptr<Transition::Builder> buildStatusTransition(const BulbId& bulbId, MiLightStatus toStatus, uint8_t startLevel);
+  std::shared_ptr<Transition::Builder> buildStatusTransition(const std::vector<BulbId>& members, MiLightStatus toStatus, uint8_t startLevel);
+  // Runs the transition built by delegate for every member in lockstep.  The delegate
+  // should be built for the first member.  Like the bulb IDs passed to the other
+  // builders, members must outlive the builder.
+  std::shared_ptr<Transition::Builder> buildGroupTransition(const std::vector<BulbId>& members, std::shared_ptr<Transition::Builder> delegate);
 
   void addTransition(std::shared_ptr<Transition> transition);
   void clear();
   void loop();
 
-  ListNode<std::shared_ptr<Transition>>* getTransitions();
+  // In heap order, not by id
+  const std::vector<ScheduledTransition>& getTransitions() const;
   Transition* getTransition(size_t id);
-  ListNode<std::shared_ptr<Transition>>* findTransition(size_t id);
   bool deleteTransition(size_t id);
 
+  size_t getNumActive() const;
+  // Total steps sent since boot
+  size_t getNumSteps() const;
+  // How late (ms) steps ran compared to when they were due.  Last is the worst step in
+  // the most recent loop() that stepped anything.  Max is since boot.
+  unsigned long getLastLag() const;
+  unsigned long getMaxLag() const;
+
+  // Packets per second the active transitions want to send at their planned periods,
+  // and how many they may send.  Budget is 0 until packet airtime is known.
+  uint32_t getDemand() const;
+  uint32_t getBudget() const;
+  size_t getStride() const;
+
+  // Planned and actual duration (ms) of the most recently finished transition, and how
+  // many have finished since boot
+  size_t getLastPlannedDuration() const;
+  unsigned long getLastActualDuration() const;
+  size_t getNumCompleted() const;
+
 private:
   Transition::TransitionFn callback;
-  LinkedList<std::shared_ptr<Transition>> activeTransitions;
+  std::vector<ScheduledTransition> schedule;
   std::vector<Transition::TransitionFn> observers;
+  TransitionSink* sink;
   size_t currentId;
   uint16_t defaultPeriod;
+  unsigned long lastLag;
+  unsigned long maxLag;
+  size_t numSteps;
+
+  AirtimeFn airtimeSource;
+  // Sum of every active transition's packet rate, in packets per 1000 seconds
+  uint32_t demand;
+  size_t stride;
+  size_t lastPlannedDuration;
+  unsigned long lastActualDuration;
+  size_t numCompleted;
+
+  static uint32_t packetRate(const Transition& transition);
+  uint32_t computeBudget() const;
+  void updateStride();
+  void removeDemand(const Transition& transition);
 
+  std::vector<ScheduledTransition>::iterator findTransition(size_t id);
   void transitionCallback(const BulbId& bulbId, GroupStateField field, uint16_t arg);
 };
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include <BulbId.h>
+#include <GroupStateField.h>
+#include <stdint.h>
+
+#pragma once
+
+/*
+ * Receives transition steps.  Unlike listeners, which are generic std::functions, this
+ * is meant to go straight to the packet formatter for the bulb.
+ */
+class TransitionSink {
+public:
+  virtual ~TransitionSink() = default;
+
+  virtual void applyTransitionStep(const BulbId& bulbId, GroupStateField field, uint16_t value) = 0;
+
+  // Bracket the steps applied in one pass of TransitionController::loop, so a sink
+  // can send them together.
+  virtual void beginTransitionSteps() { }
+  virtual void endTransitionSteps() { }
+};
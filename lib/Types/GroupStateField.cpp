@@ -1,7 +1,8 @@
 #include <GroupStateField.h>
+#include <PerfectHash.h>
 #include <Size.h>
 
-static const char* STATE_NAMES[] = {
+static constexpr const char* STATE_NAMES[] = {
   GroupStateFieldNames::UNKNOWN,
   GroupStateFieldNames::STATE,
   GroupStateFieldNames::STATUS,
@@ -24,13 +25,15 @@ static const char* STATE_NAMES[] = {
   GroupStateFieldNames::COLOR_MODE,
 };
 
+static constexpr PerfectHashTable<64> STATE_NAMES_HASH PROGMEM = buildPerfectHash<64>(STATE_NAMES);
+
 GroupStateField GroupStateFieldHelpers::getFieldByName(const char* name) {
-  for (size_t i = 0; i < size(STATE_NAMES); i++) {
-    if (0 == strcmp(name, STATE_NAMES[i])) {
-      return static_cast<GroupStateField>(i);
-    }
+  int16_t index = perfectHashLookup(STATE_NAMES_HASH, STATE_NAMES, name);
+
+  if (index < 0) {
+    return GroupStateField::UNKNOWN;
   }
-  return GroupStateField::UNKNOWN;
+  return static_cast<GroupStateField>(index);
 }
 
 const char* GroupStateFieldHelpers::getFieldName(GroupStateField field) {
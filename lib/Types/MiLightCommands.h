@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdint.h>
+
 namespace MiLightCommandNames {
   static const char UNPAIR[] = "unpair";
   static const char PAIR[] = "pair";
@@ -15,4 +17,22 @@ namespace MiLightCommandNames {
   static const char MODE_SPEED_UP[] = "mode_speed_up";
   static const char TOGGLE[] = "toggle";
   static const char TRANSITION[] = "transition";
-};
\ No newline at end of file
+};
+
+// Commands that can be sent without arguments.  "brightness_up"/"brightness_down" are
+// accepted as aliases for LEVEL_UP/LEVEL_DOWN.
+enum class MiLightCommand : uint8_t {
+  UNPAIR,
+  PAIR,
+  SET_WHITE,
+  NIGHT_MODE,
+  LEVEL_UP,
+  LEVEL_DOWN,
+  TEMPERATURE_UP,
+  TEMPERATURE_DOWN,
+  NEXT_MODE,
+  PREVIOUS_MODE,
+  MODE_SPEED_DOWN,
+  MODE_SPEED_UP,
+  TOGGLE
+};
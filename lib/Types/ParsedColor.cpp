@@ -1,16 +1,14 @@
 #include <ParsedColor.h>
-#include <RGBConverter.h>
+#include <stdlib.h>
+#include <ColorConversion.h>
 #include <TokenIterator.h>
 #include <GroupStateField.h>
 #include <IntParsing.h>
 
 ParsedColor ParsedColor::fromRgb(uint16_t r, uint16_t g, uint16_t b) {
-  double hsv[3];
-  RGBConverter converter;
-  converter.rgbToHsv(r, g, b, hsv);
-
-  uint16_t hue = round(hsv[0]*360);
-  uint8_t saturation = round(hsv[1]*100);
+  uint16_t hue;
+  uint8_t saturation;
+  ColorConversion::rgbToHsv(r, g, b, hue, saturation);
 
   return ParsedColor{
     .success = true,
@@ -63,4 +61,10 @@ ParsedColor ParsedColor::fromJson(JsonVariant json) {
   }
 
   return ParsedColor::fromRgb(r, g, b);
-}
\ No newline at end of file
+}
+
+bool ParsedColor::isWhite() const {
+  return abs(r - g) < RGB_WHITE_THRESHOLD
+    && abs(g - b) < RGB_WHITE_THRESHOLD
+    && abs(r - b) < RGB_WHITE_THRESHOLD;
+}
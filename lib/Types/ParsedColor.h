@@ -3,11 +3,17 @@
 
 #pragma once
 
+// Used to determine RGB colros that are approximately white
+#define RGB_WHITE_THRESHOLD 10
+
 struct ParsedColor {
   bool success;
   uint16_t hue, r, g, b;
   uint8_t saturation;
 
+  // True if the color is close enough to white that bulbs should use white mode
+  bool isWhite() const;
+
   static ParsedColor fromRgb(uint16_t r, uint16_t g, uint16_t b);
   static ParsedColor fromJson(JsonVariant json);
 };
\ No newline at end of file
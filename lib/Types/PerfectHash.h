@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Perfect hash over a fixed set of strings, built at compile time.
+ *
+ * buildPerfectHash searches for a seed under which every key lands in a distinct slot
+ * of a table of SLOTS entries.  Each slot holds the index of its key plus one (zero is
+ * empty), so a lookup is one hash and one strcmp to reject strings that aren't keys.
+ * SLOTS should be a few times the number of keys so a seed is found quickly.
+ *
+ * Tables must be declared constexpr.  A key set the search can't solve then fails the
+ * build instead of falling back to a search at boot.
+ */
+template <size_t SLOTS>
+struct PerfectHashTable {
+  uint32_t seed;
+  uint8_t slots[SLOTS];
+};
+
+// FNV-1a, with the seed mixed into the offset basis
+constexpr uint32_t perfectHashString(const char* key, uint32_t seed) {
+  uint32_t hash = 2166136261UL ^ seed;
+
+  while (*key) {
+    hash ^= static_cast<uint8_t>(*key++);
+    hash *= 16777619UL;
+  }
+
+  return hash;
+}
+
+// Low bits of FNV only depend on the low bits of the seed, so fold the high bits in
+// before reducing.  Otherwise only SLOTS distinct seeds would ever be tried.
+template <size_t SLOTS>
+constexpr size_t perfectHashSlot(const char* key, uint32_t seed) {
+  const uint32_t hash = perfectHashString(key, seed);
+  return (hash ^ (hash >> 16)) % SLOTS;
+}
+
+template <size_t SLOTS, size_t NUM_KEYS>
+constexpr PerfectHashTable<SLOTS> buildPerfectHash(const char* const (&keys)[NUM_KEYS]) {
+  static_assert(NUM_KEYS < SLOTS && NUM_KEYS < 255, "Perfect hash table is too small");
+
+  for (uint32_t seed = 0; ; ++seed) {
+    PerfectHashTable<SLOTS> table{};
+    table.seed = seed;
+    bool collision = false;
+
+    for (size_t i = 0; i < NUM_KEYS && !collision; ++i) {
+      size_t slot = perfectHashSlot<SLOTS>(keys[i], seed);
+
+      if (table.slots[slot] != 0) {
+        collision = true;
+      } else {
+        table.slots[slot] = i + 1;
+      }
+    }
+
+    if (!collision) {
+      return table;
+    }
+  }
+}
+
+// Index of key in keys, or -1 if it isn't one of them.  table must be in PROGMEM.
+template <size_t SLOTS, size_t NUM_KEYS>
+int16_t perfectHashLookup(
+  const PerfectHashTable<SLOTS>& table,
+  const char* const (&keys)[NUM_KEYS],
+  const char* key
+) {
+  if (key == NULL) {
+    return -1;
+  }
+
+  uint32_t seed = pgm_read_dword(&table.seed);
+  uint8_t entry = pgm_read_byte(&table.slots[perfectHashSlot<SLOTS>(key, seed)]);
+
+  if (entry == 0 || strcmp(key, keys[entry - 1]) != 0) {
+    return -1;
+  }
+
+  return entry - 1;
+}
@@ -0,0 +1,329 @@
+#include <StateUpdate.h>
+#include <Size.h>
+#include <PerfectHash.h>
+
+static constexpr const char* COMMAND_NAMES[] = {
+  MiLightCommandNames::UNPAIR,
+  MiLightCommandNames::PAIR,
+  MiLightCommandNames::SET_WHITE,
+  MiLightCommandNames::NIGHT_MODE,
+  MiLightCommandNames::LEVEL_UP,
+  MiLightCommandNames::LEVEL_DOWN,
+  "brightness_up",
+  "brightness_down",
+  MiLightCommandNames::TEMPERATURE_UP,
+  MiLightCommandNames::TEMPERATURE_DOWN,
+  MiLightCommandNames::NEXT_MODE,
+  MiLightCommandNames::PREVIOUS_MODE,
+  MiLightCommandNames::MODE_SPEED_DOWN,
+  MiLightCommandNames::MODE_SPEED_UP,
+  MiLightCommandNames::TOGGLE
+};
+
+// Parallel to COMMAND_NAMES
+static const MiLightCommand COMMAND_VALUES[] = {
+  MiLightCommand::UNPAIR,
+  MiLightCommand::PAIR,
+  MiLightCommand::SET_WHITE,
+  MiLightCommand::NIGHT_MODE,
+  MiLightCommand::LEVEL_UP,
+  MiLightCommand::LEVEL_DOWN,
+  MiLightCommand::LEVEL_UP,
+  MiLightCommand::LEVEL_DOWN,
+  MiLightCommand::TEMPERATURE_UP,
+  MiLightCommand::TEMPERATURE_DOWN,
+  MiLightCommand::NEXT_MODE,
+  MiLightCommand::PREVIOUS_MODE,
+  MiLightCommand::MODE_SPEED_DOWN,
+  MiLightCommand::MODE_SPEED_UP,
+  MiLightCommand::TOGGLE
+};
+
+static_assert(size(COMMAND_NAMES) == size(COMMAND_VALUES), "Command names and values must match");
+
+static constexpr PerfectHashTable<64> COMMAND_NAMES_HASH PROGMEM = buildPerfectHash<64>(COMMAND_NAMES);
+
+// Keys understood by fromJson.  Order must match RequestKey.
+static constexpr const char* REQUEST_KEYS[] = {
+  GroupStateFieldNames::STATE,
+  GroupStateFieldNames::STATUS,
+  MiLightCommandNames::TRANSITION,
+  GroupStateFieldNames::HUE,
+  GroupStateFieldNames::SATURATION,
+  GroupStateFieldNames::KELVIN,
+  GroupStateFieldNames::TEMPERATURE,
+  GroupStateFieldNames::COLOR_TEMP,
+  GroupStateFieldNames::MODE,
+  GroupStateFieldNames::EFFECT,
+  GroupStateFieldNames::COLOR,
+  GroupStateFieldNames::LEVEL,
+  GroupStateFieldNames::BRIGHTNESS,
+  GroupStateFieldNames::COMMAND,
+  GroupStateFieldNames::COMMANDS,
+  "button_id",
+  "argument"
+};
+
+enum class RequestKey : int16_t {
+  STATE,
+  STATUS,
+  TRANSITION,
+  HUE,
+  SATURATION,
+  KELVIN,
+  TEMPERATURE,
+  COLOR_TEMP,
+  MODE,
+  EFFECT,
+  COLOR,
+  LEVEL,
+  BRIGHTNESS,
+  COMMAND,
+  COMMANDS,
+  BUTTON_ID,
+  ARGUMENT
+};
+
+static constexpr PerfectHashTable<64> REQUEST_KEYS_HASH PROGMEM = buildPerfectHash<64>(REQUEST_KEYS);
+
+StateUpdate::StateUpdate()
+  : fields(0)
+  , numCommands(0)
+  , transition(0)
+{ }
+
+StateUpdate& StateUpdate::setStatus(MiLightStatus status) {
+  this->status = status;
+  fields |= STATUS;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setHue(uint16_t hue) {
+  this->hue = hue;
+  fields |= HUE;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setSaturation(uint8_t saturation) {
+  this->saturation = saturation;
+  fields |= SATURATION;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setKelvin(uint8_t kelvin) {
+  this->kelvin = kelvin;
+  fields |= KELVIN;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setColorTemp(uint16_t mireds) {
+  this->colorTemp = mireds;
+  fields |= COLOR_TEMP;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setMode(uint8_t mode) {
+  this->mode = mode;
+  fields |= MODE;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setEffect(MiLightCommand effect) {
+  this->effect = effect;
+  fields |= EFFECT;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setColor(const ParsedColor& color) {
+  this->color = color;
+  fields |= COLOR;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setLevel(uint8_t level) {
+  this->level = level;
+  fields |= LEVEL;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setBrightness(uint8_t brightness) {
+  this->brightness = brightness;
+  fields |= BRIGHTNESS;
+  return *this;
+}
+
+StateUpdate& StateUpdate::addCommand(MiLightCommand command) {
+  if (numCommands < MILIGHT_MAX_UPDATE_COMMANDS) {
+    commands[numCommands++] = command;
+    fields |= COMMANDS;
+  } else {
+    Serial.println(F("StateUpdate - WARN: too many commands, ignoring the rest"));
+  }
+  return *this;
+}
+
+StateUpdate& StateUpdate::setRawCommand(uint8_t buttonId, uint8_t argument) {
+  this->buttonId = buttonId;
+  this->argument = argument;
+  fields |= RAW_COMMAND;
+  return *this;
+}
+
+StateUpdate& StateUpdate::setTransition(float duration) {
+  this->transition = duration;
+  fields |= TRANSITION;
+  return *this;
+}
+
+bool StateUpdate::parseCommand(const char* name, MiLightCommand& command) {
+  int16_t index = perfectHashLookup(COMMAND_NAMES_HASH, COMMAND_NAMES, name);
+
+  if (index < 0) {
+    return false;
+  }
+
+  command = COMMAND_VALUES[index];
+  return true;
+}
+
+static void addJsonCommand(StateUpdate& update, JsonVariant command) {
+  const char* name = NULL;
+
+  if (command.is<JsonObject>()) {
+    name = command[GroupStateFieldNames::COMMAND];
+  } else if (command.is<const char*>()) {
+    name = command.as<const char*>();
+  }
+
+  MiLightCommand parsed;
+  if (StateUpdate::parseCommand(name, parsed)) {
+    update.addCommand(parsed);
+  }
+}
+
+StateUpdate StateUpdate::fromJson(JsonObject request) {
+  StateUpdate update;
+
+  // Keys whose meaning depends on other keys are collected during the pass over the
+  // request and resolved afterwards, so the result doesn't depend on key order.
+  JsonVariant state, status, kelvin, temperature, mode, effect, command, commands, buttonId, argument;
+
+  for (JsonPair kv : request) {
+    JsonVariant value = kv.value();
+
+    switch (static_cast<RequestKey>(perfectHashLookup(REQUEST_KEYS_HASH, REQUEST_KEYS, kv.key().c_str()))) {
+      case RequestKey::STATE:
+        state = value;
+        break;
+      case RequestKey::STATUS:
+        status = value;
+        break;
+      case RequestKey::TRANSITION:
+        if (value.is<float>()) {
+          update.setTransition(value.as<float>());
+        } else if (value.is<size_t>()) {
+          update.setTransition(value.as<size_t>());
+        } else if (!value.isNull()) {
+          Serial.println(F("StateUpdate - WARN: unsupported transition type.  Must be float or int."));
+        }
+        break;
+      case RequestKey::HUE:
+        update.setHue(value);
+        break;
+      case RequestKey::SATURATION:
+        update.setSaturation(value);
+        break;
+      case RequestKey::KELVIN:
+        kelvin = value;
+        break;
+      case RequestKey::TEMPERATURE:
+        temperature = value;
+        break;
+      case RequestKey::COLOR_TEMP:
+        update.setColorTemp(value);
+        break;
+      case RequestKey::MODE:
+        mode = value;
+        break;
+      case RequestKey::EFFECT:
+        effect = value;
+        break;
+      case RequestKey::COLOR:
+        {
+          ParsedColor color = ParsedColor::fromJson(value);
+
+          if (color.success) {
+            update.setColor(color);
+          } else {
+            Serial.println(F("Error parsing color field, unrecognized format"));
+          }
+        }
+        break;
+      case RequestKey::LEVEL:
+        update.setLevel(value);
+        break;
+      case RequestKey::BRIGHTNESS:
+        update.setBrightness(value);
+        break;
+      case RequestKey::COMMAND:
+        command = value;
+        break;
+      case RequestKey::COMMANDS:
+        commands = value;
+        break;
+      case RequestKey::BUTTON_ID:
+        buttonId = value;
+        break;
+      case RequestKey::ARGUMENT:
+        argument = value;
+        break;
+      default:
+        break;
+    }
+  }
+
+  // status takes precedence over state
+  if (!status.isNull()) {
+    update.setStatus(parseMilightStatus(status));
+  } else if (!state.isNull()) {
+    update.setStatus(parseMilightStatus(state));
+  }
+
+  // temperature is an alias for kelvin, and wins if both are given
+  if (!temperature.isNull()) {
+    update.setKelvin(temperature);
+  } else if (!kelvin.isNull()) {
+    update.setKelvin(kelvin);
+  }
+
+  if (!mode.isNull()) {
+    update.setMode(mode);
+  }
+  if (!effect.isNull()) {
+    String effectName = effect;
+
+    if (effectName == MiLightCommandNames::NIGHT_MODE) {
+      update.setEffect(MiLightCommand::NIGHT_MODE);
+    } else if (effectName == "white" || effectName == "white_mode") {
+      update.setEffect(MiLightCommand::SET_WHITE);
+    } else { // assume we're trying to set mode
+      update.setMode(effectName.toInt());
+    }
+  }
+
+  if (!command.isNull()) {
+    addJsonCommand(update, command);
+  }
+  if (commands.is<JsonArray>()) {
+    for (JsonVariant entry : commands.as<JsonArray>()) {
+      addJsonCommand(update, entry);
+    }
+  }
+
+  // Raw packet command/args
+  if (!buttonId.isNull() && !argument.isNull()) {
+    update.setRawCommand(buttonId, argument);
+  }
+
+  return update;
+}
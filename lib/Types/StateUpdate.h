@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <ArduinoJson.h>
+#include <GroupStateField.h>
+#include <MiLightStatus.h>
+#include <MiLightCommands.h>
+#include <ParsedColor.h>
+
+// Maximum number of argument-less commands carried by a single update
+#ifndef MILIGHT_MAX_UPDATE_COMMANDS
+#define MILIGHT_MAX_UPDATE_COMMANDS 8
+#endif
+
+/*
+ * Typed form of an update request for MiLightClient::update.  Which fields are present
+ * is tracked in a bitmask, and values are stored in their native units, so internal
+ * producers (RS485, transitions) never need to build JSON.  JSON requests from the
+ * HTTP and MQTT APIs are converted once with fromJson.
+ */
+struct StateUpdate {
+  enum Field : uint16_t {
+    STATUS      = 1 << 0,
+    HUE         = 1 << 1,
+    SATURATION  = 1 << 2,
+    KELVIN      = 1 << 3,
+    COLOR_TEMP  = 1 << 4,
+    MODE        = 1 << 5,
+    EFFECT      = 1 << 6,
+    COLOR       = 1 << 7,
+    LEVEL       = 1 << 8,
+    BRIGHTNESS  = 1 << 9,
+    COMMANDS    = 1 << 10,
+    RAW_COMMAND = 1 << 11,
+    TRANSITION  = 1 << 12
+  };
+
+  uint16_t fields;
+
+  MiLightStatus status;
+  uint16_t hue;
+  uint8_t saturation;
+  // White temperature in [0, 100]
+  uint8_t kelvin;
+  uint16_t colorTemp;
+  uint8_t mode;
+  // Non-numeric effect (NIGHT_MODE or SET_WHITE).  Numeric effects are stored as mode.
+  MiLightCommand effect;
+  ParsedColor color;
+  // Brightness in [0, 100]
+  uint8_t level;
+  // Brightness in [0, 255]
+  uint8_t brightness;
+  MiLightCommand commands[MILIGHT_MAX_UPDATE_COMMANDS];
+  uint8_t numCommands;
+  uint8_t buttonId;
+  uint8_t argument;
+  // Transition duration in seconds
+  float transition;
+
+  StateUpdate();
+
+  inline bool has(Field field) const { return (fields & field) != 0; }
+
+  StateUpdate& setStatus(MiLightStatus status);
+  StateUpdate& setHue(uint16_t hue);
+  StateUpdate& setSaturation(uint8_t saturation);
+  StateUpdate& setKelvin(uint8_t kelvin);
+  StateUpdate& setColorTemp(uint16_t mireds);
+  StateUpdate& setMode(uint8_t mode);
+  StateUpdate& setEffect(MiLightCommand effect);
+  StateUpdate& setColor(const ParsedColor& color);
+  StateUpdate& setLevel(uint8_t level);
+  StateUpdate& setBrightness(uint8_t brightness);
+  StateUpdate& addCommand(MiLightCommand command);
+  StateUpdate& setRawCommand(uint8_t buttonId, uint8_t argument);
+  StateUpdate& setTransition(float duration);
+
+  // Convert a JSON request.  Commands that take arguments (transitions) can't be
+  // represented and are skipped; callers handle those from the JSON directly.
+  static StateUpdate fromJson(JsonObject request);
+
+  // Returns false if the name isn't an argument-less command
+  static bool parseCommand(const char* name, MiLightCommand& command);
+};
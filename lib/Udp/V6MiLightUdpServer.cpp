@@ -210,6 +210,12 @@ void V6MiLightUdpServer::handleCommand(
 
   if (cmdHeader == 0) {
     handled = handleOpenCommand(sessionId);
+  } else if (client->isBackpressured()) {
+    // Withhold the ACK so that the client resends once the queue has drained
+#ifdef MILIGHT_UDP_DEBUG
+    printf("V6MiLightUdpServer - Packet queue full, not acknowledging command\n");
+#endif
+    return;
   } else {
     handled = COMMAND_DEMUXER.handleCommand(
       client,
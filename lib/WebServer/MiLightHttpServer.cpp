@@ -108,6 +108,20 @@ void MiLightHttpServer::begin() {
     .on(HTTP_PUT, std::bind(&MiLightHttpServer::handleUpdateAlias, this, _1))
     .on(HTTP_DELETE, std::bind(&MiLightHttpServer::handleDeleteAlias, this, _1));
 
+  server
+    .buildHandler("/scenes")
+    .on(HTTP_GET, std::bind(&MiLightHttpServer::handleListScenes, this, _1))
+    .on(HTTP_POST, std::bind(&MiLightHttpServer::handleCreateScene, this, _1));
+
+  server
+    .buildHandler("/scenes/:id")
+    .on(HTTP_GET, std::bind(&MiLightHttpServer::handleGetScene, this, _1))
+    .on(HTTP_DELETE, std::bind(&MiLightHttpServer::handleDeleteScene, this, _1));
+
+  server
+    .buildHandler("/scenes/:id/activate")
+    .on(HTTP_POST, std::bind(&MiLightHttpServer::handleActivateScene, this, _1));
+
   server
     .buildHandler("/firmware")
     .handleOTA();
@@ -189,12 +203,82 @@ void MiLightHttpServer::onGroupDeleted(GroupDeletedHandler handler) {
   this->groupDeletedHandler = handler;
 }
 
+void MiLightHttpServer::onBackgroundTasks(BackgroundTaskHandler handler) {
+  this->backgroundTaskHandler = handler;
+}
+
 void MiLightHttpServer::handleAbout(RequestContext& request) {
   AboutHelper::generateAboutObject(request.response.json);
 
   JsonObject queueStats = request.response.json.createNestedObject("queue_stats");
   queueStats[F("length")] = packetSender->queueLength();
   queueStats[F("dropped_packets")] = packetSender->droppedPackets();
+
+  if (settings.adaptivePacketRepeats) {
+    const RepeatLearner& learner = packetSender->getRepeatLearner();
+    queueStats[F("learned_devices")] = learner.getNumTrackedDevices();
+    queueStats[F("reduced_repeat_sends")] = packetSender->reducedRepeatSends();
+  }
+
+  queueStats[F("backpressured")] = packetSender->isBackpressured();
+  queueStats[F("backpressure_events")] = packetSender->backpressureEvents();
+
+  MiLightRadioStats stats = radios->getRadioStats();
+  JsonObject radioStats = request.response.json.createNestedObject("radio_stats");
+  radioStats[F("packets_seen")] = stats.packetsSeen;
+  radioStats[F("crc_failures")] = stats.crcFailures;
+  radioStats[F("duplicates")] = stats.duplicates;
+  radioStats[F("suppressed_repeats")] = radios->getReceivedPacketFilter().getSuppressedCount();
+
+  if (radios->hasIrq()) {
+    radioStats[F("irq_events")] = stats.irqEvents;
+    radioStats[F("irq_overflows")] = stats.irqOverflows;
+    radioStats[F("irq_max_latency_ms")] = stats.irqMaxLatency;
+  }
+
+  size_t templateHits = 0;
+  size_t templateMisses = 0;
+
+  for (size_t i = 0; i < MiLightRemoteConfig::NUM_REMOTES; i++) {
+    templateHits += MiLightRemoteConfig::ALL_REMOTES[i]->packetFormatter->getTemplateHits();
+    templateMisses += MiLightRemoteConfig::ALL_REMOTES[i]->packetFormatter->getTemplateMisses();
+  }
+
+  queueStats[F("packet_template_hits")] = templateHits;
+  queueStats[F("packet_template_misses")] = templateMisses;
+  queueStats[F("suppressed_packets")] = milightClient->getSuppressedPackets();
+  queueStats[F("packet_service_us")] = packetSender->getPacketServiceTime();
+
+  JsonObject transitionStats = request.response.json.createNestedObject("transition_stats");
+  transitionStats[F("active")] = transitions.getNumActive();
+  transitionStats[F("steps")] = transitions.getNumSteps();
+  transitionStats[F("lag_ms")] = transitions.getLastLag();
+  transitionStats[F("max_lag_ms")] = transitions.getMaxLag();
+  transitionStats[F("demand_pps")] = transitions.getDemand();
+  transitionStats[F("budget_pps")] = transitions.getBudget();
+  transitionStats[F("stride")] = transitions.getStride();
+  transitionStats[F("completed")] = transitions.getNumCompleted();
+  transitionStats[F("last_planned_ms")] = transitions.getLastPlannedDuration();
+  transitionStats[F("last_actual_ms")] = transitions.getLastActualDuration();
+
+  const ListenScheduler& scheduler = radios->getListenScheduler();
+  JsonArray listenStats = request.response.json.createNestedArray("listen_stats");
+
+  for (size_t i = 0; i < MiLightRadioConfig::NUM_CONFIGS; i++) {
+    const ListenScheduler::ConfigStats& configStats = scheduler.getStats(i);
+    JsonObject config = listenStats.createNestedObject();
+    JsonArray remotes = config.createNestedArray(F("remotes"));
+
+    for (size_t j = 0; j < MiLightRemoteConfig::NUM_REMOTES; j++) {
+      if (&MiLightRemoteConfig::ALL_REMOTES[j]->radioConfig == &MiLightRadioConfig::ALL_CONFIGS[i]) {
+        remotes.add(MiLightRemoteConfig::ALL_REMOTES[j]->name);
+      }
+    }
+
+    config[F("polls")] = configStats.polls;
+    config[F("hits")] = configStats.hits;
+    config[F("weight")] = scheduler.getWeight(i);
+  }
 }
 
 void MiLightHttpServer::handleGetRadioConfigs(RequestContext& request) {
@@ -320,7 +404,7 @@ void MiLightHttpServer::handleListenGateway(RequestContext& request) {
   }
 
   if (tmpRemoteConfig != NULL) {
-    radio = radios->switchRadio(tmpRemoteConfig);
+    radio = radios->switchListenRadio(tmpRemoteConfig);
   }
 
   while (remoteConfig == NULL) {
@@ -329,7 +413,7 @@ void MiLightHttpServer::handleListenGateway(RequestContext& request) {
     }
 
     if (listenAll) {
-      radio = radios->switchRadio(configIx++ % radios->getNumRadios());
+      radio = radios->switchListenRadio(configIx++ % radios->getNumRadios());
     } else {
       radio->configure();
     }
@@ -364,9 +448,8 @@ void MiLightHttpServer::sendGroupState(bool allowAsync, BulbId& bulbId, RichHttp
   bool blockOnQueue = server.arg("blockOnQueue").equalsIgnoreCase("true");
 
   // Wait for packet queue to flush out.  State will not have been updated before that.
-  // Bit hacky to call loop outside of main loop, but should be fine.
-  while (blockOnQueue && packetSender->isSending()) {
-    packetSender->loop();
+  if (blockOnQueue) {
+    waitForPackets(packetSender->lastEnqueuedToken());
   }
 
   JsonObject obj = response.json.to<JsonObject>();
@@ -461,6 +544,10 @@ void MiLightHttpServer::_handleDeleteGroup(BulbId bulbId, RequestContext& reques
 }
 
 void MiLightHttpServer::handleUpdateGroupAlias(RequestContext& request) {
+  if (rejectIfBackpressured(request)) {
+    return;
+  }
+
   const String alias = request.pathVariables.get("device_alias");
 
   auto it = settings.groupIdAliases.find(alias);
@@ -488,14 +575,18 @@ void MiLightHttpServer::handleUpdateGroupAlias(RequestContext& request) {
 }
 
 void MiLightHttpServer::handleUpdateGroup(RequestContext& request) {
+  if (rejectIfBackpressured(request)) {
+    return;
+  }
+
   JsonObject reqObj = request.getJsonBody().as<JsonObject>();
 
   String _deviceIds = request.pathVariables.get(GroupStateFieldNames::DEVICE_ID);
   String _groupIds = request.pathVariables.get(GroupStateFieldNames::GROUP_ID);
   String _remoteTypes = request.pathVariables.get("type");
-  char deviceIds[_deviceIds.length()];
-  char groupIds[_groupIds.length()];
-  char remoteTypes[_remoteTypes.length()];
+  char deviceIds[_deviceIds.length() + 1];
+  char groupIds[_groupIds.length() + 1];
+  char remoteTypes[_remoteTypes.length() + 1];
   strcpy(remoteTypes, _remoteTypes.c_str());
   strcpy(groupIds, _groupIds.c_str());
   strcpy(deviceIds, _deviceIds.c_str());
@@ -504,8 +595,7 @@ void MiLightHttpServer::handleUpdateGroup(RequestContext& request) {
   TokenIterator groupIdItr(groupIds, _groupIds.length());
   TokenIterator remoteTypesItr(remoteTypes, _remoteTypes.length());
 
-  BulbId foundBulbId;
-  size_t groupCount = 0;
+  std::vector<BulbId> targets;
 
   while (remoteTypesItr.hasNext()) {
     const char* _remoteType = remoteTypesItr.nextToken();
@@ -527,21 +617,47 @@ void MiLightHttpServer::handleUpdateGroup(RequestContext& request) {
       while (groupIdItr.hasNext()) {
         const uint8_t groupId = atoi(groupIdItr.nextToken());
 
-        milightClient->prepare(config, deviceId, groupId);
-        handleRequest(reqObj);
-        foundBulbId = BulbId(deviceId, groupId, config->type);
-        groupCount++;
+        targets.push_back(BulbId(deviceId, groupId, config->type));
       }
     }
   }
 
-  if (groupCount == 1) {
-    sendGroupState(false, foundBulbId, request.response);
+  handleRequest(reqObj, targets);
+
+  if (targets.size() == 1) {
+    sendGroupState(false, targets[0], request.response);
   } else {
     request.response.json["success"] = true;
   }
 }
 
+void MiLightHttpServer::waitForPackets(PacketSender::CompletionToken token) {
+  // Only our own packets (and those ahead of them) are waited on.  Anything enqueued
+  // by background tasks in the mean time doesn't hold up the response.
+  while (! packetSender->isComplete(token)) {
+    packetSender->loop();
+
+    if (backgroundTaskHandler) {
+      backgroundTaskHandler();
+    }
+
+    yield();
+  }
+}
+
+bool MiLightHttpServer::rejectIfBackpressured(RequestContext& request) {
+  if (! packetSender->isBackpressured()) {
+    return false;
+  }
+
+  server.sendHeader("Retry-After", "1");
+  request.response.setCode(503);
+  request.response.json[F("success")] = false;
+  request.response.json[F("error")] = F("Packet queue is full.  Retry later.");
+
+  return true;
+}
+
 void MiLightHttpServer::handleRequest(const JsonObject& request) {
   milightClient->setRepeatsOverride(
     settings.httpRepeatFactor * settings.packetRepeats
@@ -550,7 +666,19 @@ void MiLightHttpServer::handleRequest(const JsonObject& request) {
   milightClient->clearRepeatsOverride();
 }
 
+void MiLightHttpServer::handleRequest(const JsonObject& request, const std::vector<BulbId>& targets) {
+  milightClient->setRepeatsOverride(
+    settings.httpRepeatFactor * settings.packetRepeats
+  );
+  milightClient->update(request, targets);
+  milightClient->clearRepeatsOverride();
+}
+
 void MiLightHttpServer::handleSendRaw(RequestContext& request) {
+  if (rejectIfBackpressured(request)) {
+    return;
+  }
+
   JsonObject requestBody = request.getJsonBody().as<JsonObject>();
   const MiLightRemoteConfig* config = MiLightRemoteConfig::fromType(request.pathVariables.get("type"));
 
@@ -571,12 +699,10 @@ void MiLightHttpServer::handleSendRaw(RequestContext& request) {
     numRepeats = requestBody["num_repeats"];
   }
 
-  packetSender->enqueue(packet, config, numRepeats);
+  PacketSender::CompletionToken token = packetSender->enqueue(packet, config, numRepeats);
 
   // To make this response synchronous, wait for packet to be flushed
-  while (packetSender->isSending()) {
-    packetSender->loop();
-  }
+  waitForPackets(token);
 
   request.response.json["success"] = true;
 }
@@ -655,24 +781,32 @@ void MiLightHttpServer::handleDeleteTransition(RequestContext& request) {
 }
 
 void MiLightHttpServer::handleListTransitions(RequestContext& request) {
-  auto current = transitions.getTransitions();
-  JsonArray transitions = request.response.json.to<JsonObject>().createNestedArray(F("transitions"));
+  JsonArray transitionsJson = request.response.json.to<JsonObject>().createNestedArray(F("transitions"));
 
-  while (current != nullptr) {
-    JsonObject json = transitions.createNestedObject();
-    current->data->serialize(json);
-    current = current->next;
+  for (const auto& entry : transitions.getTransitions()) {
+    JsonObject json = transitionsJson.createNestedObject();
+    entry.transition->serialize(json);
   }
 }
 
 void MiLightHttpServer::handleCreateTransition(RequestContext& request) {
   JsonObject body = request.getJsonBody().as<JsonObject>();
 
+  // Group transitions list their bulbs in the body
+  if (body.containsKey(FPSTR(TransitionParams::BULBS))) {
+    if (milightClient->handleTransition(body, request.response.json)) {
+      request.response.json[F("success")] = true;
+    } else {
+      request.response.setCode(400);
+    }
+    return;
+  }
+
   if (! body.containsKey(GroupStateFieldNames::DEVICE_ID)
     || ! body.containsKey(GroupStateFieldNames::GROUP_ID)
     || (!body.containsKey(F("remote_type")) && !body.containsKey(GroupStateFieldNames::DEVICE_TYPE))) {
     char buffer[200];
-    sprintf_P(buffer, PSTR("Must specify required keys: device_id, group_id, device_type"));
+    sprintf_P(buffer, PSTR("Must specify required keys: device_id, group_id, device_type (or bulbs)"));
 
     request.response.setCode(400);
     request.response.json[F("error")] = buffer;
@@ -795,6 +929,118 @@ void MiLightHttpServer::handleDeleteAlias(RequestContext& request) {
   }
 }
 
+void MiLightHttpServer::handleListScenes(RequestContext& request) {
+  JsonArray list = request.response.json.to<JsonObject>().createNestedArray(F("scenes"));
+
+  for (auto& scene : scenes.getScenes()) {
+    JsonObject jsonScene = list.createNestedObject();
+    jsonScene[F("id")] = scene.first;
+    jsonScene[F("name")] = scene.second.name;
+    jsonScene[F("num_members")] = scene.second.members.size();
+  }
+}
+
+void MiLightHttpServer::handleCreateScene(RequestContext& request) {
+  JsonObject body = request.getJsonBody().as<JsonObject>();
+  JsonArray members = body[F("members")];
+
+  if (! body.containsKey(F("name")) || members.isNull() || members.size() == 0) {
+    request.response.setCode(400);
+    request.response.json[F("error")] = F("Must specify required keys: name, members");
+    return;
+  }
+
+  if (members.size() > MILIGHT_MAX_SCENE_MEMBERS) {
+    request.response.setCode(400);
+    request.response.json[F("error")] = F("Too many scene members");
+    return;
+  }
+
+  Scene scene;
+  scene.setName(body[F("name")].as<const char*>());
+
+  for (JsonObject jsonMember : members) {
+    const MiLightRemoteConfig* config = MiLightRemoteConfig::fromType(jsonMember[GroupStateFieldNames::DEVICE_TYPE].as<String>());
+
+    if (config == NULL
+      || ! jsonMember.containsKey(GroupStateFieldNames::DEVICE_ID)
+      || ! jsonMember.containsKey(GroupStateFieldNames::GROUP_ID)) {
+      request.response.setCode(400);
+      request.response.json[F("error")] = F("Each member must specify device_id, group_id and a valid device_type");
+      return;
+    }
+
+    SceneMember member;
+    member.bulbId = BulbId(
+      jsonMember[GroupStateFieldNames::DEVICE_ID].as<uint16_t>(),
+      jsonMember[GroupStateFieldNames::GROUP_ID].as<uint8_t>(),
+      config->type
+    );
+    member.state = SceneState::fromUpdate(StateUpdate::fromJson(jsonMember));
+
+    // Members without a target state capture the bulb's current state
+    if (member.state.fields == 0) {
+      GroupState* state = stateStore->get(member.bulbId);
+
+      if (state != NULL) {
+        member.state = SceneState::fromGroupState(*state);
+      }
+    }
+
+    scene.members.push_back(member);
+  }
+
+  if (! scenes.add(scene)) {
+    request.response.setCode(400);
+    request.response.json[F("error")] = F("Too many scenes");
+    return;
+  }
+
+  scenes.save();
+
+  request.response.json[F("success")] = true;
+  request.response.json[F("id")] = scene.id;
+}
+
+void MiLightHttpServer::handleGetScene(RequestContext& request) {
+  const Scene* scene = scenes.get(atoi(request.pathVariables.get("id")));
+
+  if (scene == NULL) {
+    request.response.setCode(404);
+    request.response.json[F("error")] = F("Scene not found");
+    return;
+  }
+
+  scene->serialize(request.response.json.to<JsonObject>());
+}
+
+void MiLightHttpServer::handleDeleteScene(RequestContext& request) {
+  if (scenes.remove(atoi(request.pathVariables.get("id")))) {
+    scenes.save();
+    request.response.json[F("success")] = true;
+  } else {
+    request.response.setCode(404);
+    request.response.json[F("error")] = F("Scene not found");
+  }
+}
+
+void MiLightHttpServer::handleActivateScene(RequestContext& request) {
+  if (rejectIfBackpressured(request)) {
+    return;
+  }
+
+  const Scene* scene = scenes.get(atoi(request.pathVariables.get("id")));
+
+  if (scene == NULL) {
+    request.response.setCode(404);
+    request.response.json[F("error")] = F("Scene not found");
+    return;
+  }
+
+  request.response.json[F("success")] = true;
+  request.response.json[F("commands")] = scenes.activate(*scene);
+}
+
 void MiLightHttpServer::handleUpdateAlias(RequestContext& request) {
   const size_t id = atoi(request.pathVariables.get("id"));
   auto alias = settings.findAliasById(id);
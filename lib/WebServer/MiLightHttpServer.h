@@ -6,6 +6,7 @@
 #include <RadioSwitchboard.h>
 #include <PacketSender.h>
 #include <TransitionController.h>
+#include <SceneController.h>
 
 #ifndef _MILIGHT_HTTP_SERVER
 #define _MILIGHT_HTTP_SERVER
@@ -14,6 +15,7 @@
 
 typedef std::function<void(void)> SettingsSavedHandler;
 typedef std::function<void(const BulbId& id)> GroupDeletedHandler;
+typedef std::function<void(void)> BackgroundTaskHandler;
 
 using RichHttpConfig = RichHttp::Generics::Configs::EspressifBuiltin;
 using RequestContext = RichHttpConfig::RequestContextType;
@@ -32,7 +34,8 @@ public:
     GroupStateStore*& stateStore,
     PacketSender*& packetSender,
     RadioSwitchboard*& radios,
-    TransitionController& transitions
+    TransitionController& transitions,
+    SceneController& scenes
   )
     : authProvider(settings)
     , server(80, authProvider)
@@ -44,12 +47,17 @@ public:
     , packetSender(packetSender)
     , radios(radios)
     , transitions(transitions)
+    , scenes(scenes)
   { }
 
   void begin();
   void handleClient();
   void onSettingsSaved(SettingsSavedHandler handler);
   void onGroupDeleted(GroupDeletedHandler handler);
+
+  // Called repeatedly while a request waits for its packets to be sent, so that
+  // other subsystems keep running.  Must not call back into this server.
+  void onBackgroundTasks(BackgroundTaskHandler handler);
   void on(const char* path, HTTPMethod method, ESP8266WebServer::THandlerFunction handler);
   void handlePacketSent(uint8_t* packet, const MiLightRemoteConfig& config);
   WiFiClient client();
@@ -98,10 +106,25 @@ protected:
   void handleDeleteAliases(RequestContext& request);
   void handleUpdateAliases(RequestContext& request);
 
+  // CRUD methods for /scenes
+  void handleListScenes(RequestContext& request);
+  void handleCreateScene(RequestContext& request);
+  void handleGetScene(RequestContext& request);
+  void handleDeleteScene(RequestContext& request);
+  void handleActivateScene(RequestContext& request);
+
   void handleCreateBackup(RequestContext& request);
   void handleRestoreBackup(RequestContext& request);
 
   void handleRequest(const JsonObject& request);
+  void handleRequest(const JsonObject& request, const std::vector<BulbId>& targets);
+
+  // Send queued packets up to and including the one identified by the token,
+  // servicing background tasks in the mean time.
+  void waitForPackets(PacketSender::CompletionToken token);
+
+  // Respond with 503 and return true if the packet queue can't accept more commands
+  bool rejectIfBackpressured(RequestContext& request);
   void handleWsEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length);
 
   void saveSettings();
@@ -117,10 +140,12 @@ protected:
   GroupStateStore*& stateStore;
   SettingsSavedHandler settingsSavedHandler;
   GroupDeletedHandler groupDeletedHandler;
+  BackgroundTaskHandler backgroundTaskHandler;
   ESP8266WebServer::THandlerFunction _handleRootPage;
   PacketSender*& packetSender;
   RadioSwitchboard*& radios;
   TransitionController& transitions;
+  SceneController& scenes;
 
 };
 
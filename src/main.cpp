@@ -26,6 +26,8 @@
 #include <PacketSender.h>
 #include <HomeAssistantDiscoveryClient.h>
 #include <TransitionController.h>
+#include <CctRecalibrator.h>
+#include <SceneController.h>
 #include <ProjectWifi.h>
 #include <MiLightCommands.h>
 
@@ -69,6 +71,7 @@ typedef enum {
     RGB_RESET           = 26,   // softverski restart esp-m2 milight kontrolera 
     RGB_SETUP           = 27,   // cijela struktura ili više uzastopnih za podešavanje... treba definisat setup strukturu
     RGB_INFO            = 28,   // promjena sa web interfejsa... uređaji koji imaju lokalne izmjene imaju info kanal... treba definisat info strukturu
+    RGB_SCENE           = 29,   // aktivira sačuvanu scenu, id scene u prva dva bajta
     // ostavi prostora za dopune
     PWM_GET             = 32,
     PWM_SET             = 33,
@@ -108,12 +111,14 @@ std::shared_ptr<MiLightRadioFactory> radioFactory;
 MiLightHttpServer *httpServer = NULL;
 MqttClient* mqttClient = NULL;
 MiLightDiscoveryServer* discoveryServer = NULL;
-uint8_t currentRadioType = 0;
+size_t currentListenConfig = 0;
 
 // For tracking and managing group state
 GroupStateStore* stateStore = NULL;
 BulbStateUpdater* bulbStateUpdater = NULL;
 TransitionController transitions;
+CctRecalibrator* cctRecalibrator = NULL;
+SceneController scenes(milightClient, packetSender, stateStore);
 
 std::vector<std::shared_ptr<MiLightUdpServer>> udpServers;
 
@@ -134,25 +139,25 @@ void TF_WriteImpl(TinyFrame * const tf, const uint8_t *buff, uint32_t len)
 
 TF_Result GEN_Listener(TinyFrame *tf, TF_Msg *msg)
 {
-  StaticJsonDocument<50> stateFields;
+  StateUpdate update;
 
   /*if (msg->data[0] == MODBUS_SEND_WRITE_SINGLE_REGISTER)
   {
-    stateFields[GroupStateFieldNames::STATUS] = ((msg->data[3] == 2) ? "off" : "on");
+    update.setStatus((msg->data[3] == 2) ? OFF : ON);
     milightClient->prepare(MiLightRemoteType::REMOTE_TYPE_RGBW, ((msg->data[1] << 8) & 0xFF00) | msg->data[2], 1);
-    milightClient->update(stateFields.as<JsonObject>());
+    milightClient->update(update);
   }
   else if(msg->data[0] == LIGHT_SEND_BRIGHTNESS_SET)
   {
-    stateFields[GroupStateFieldNames::LEVEL] = msg->data[3];
+    update.setLevel(msg->data[3]);
     milightClient->prepare(MiLightRemoteType::REMOTE_TYPE_RGBW, ((msg->data[1] << 8) & 0xFF00) | msg->data[2], 1);
-    milightClient->update(stateFields.as<JsonObject>());
+    milightClient->update(update);
   }
   else if(msg->data[0] == LIGHT_SEND_COLOR_SET)
   {
-    stateFields[GroupStateFieldNames::HUE] = ParsedColor::fromRgb(msg->data[3], msg->data[4], msg->data[5]).hue;
+    update.setHue(ParsedColor::fromRgb(msg->data[3], msg->data[4], msg->data[5]).hue);
     milightClient->prepare(MiLightRemoteType::REMOTE_TYPE_RGBW, ((msg->data[1] << 8) & 0xFF00) | msg->data[2], 1);
-    milightClient->update(stateFields.as<JsonObject>());
+    milightClient->update(update);
   }*/
 
   return TF_STAY;
@@ -170,7 +175,7 @@ TF_Result BINARY_GET_Listener(TinyFrame *tf, TF_Msg *msg)
 TF_Result BINARY_SET_Listener(TinyFrame *tf, TF_Msg *msg)
 {
   uint8_t resp[4] = {0, 0, 0, TF_ACK}; // pozicija 3 ACK bajta u odgovoru na komande binarnom aktuatoru
-  StaticJsonDocument<50> stateFields;
+  StateUpdate update;
 
   // uzmi adresu
   uint16_t adr = (uint16_t)(msg->data[0] << 8) | msg->data[1];
@@ -184,10 +189,12 @@ TF_Result BINARY_SET_Listener(TinyFrame *tf, TF_Msg *msg)
       if (adr == deviceId)
       {
         // provjeri i podatak
-        if (msg->data[2] == 1)
-          stateFields[GroupStateFieldNames::STATUS] = "on";
+        if (packetSender->isBackpressured())
+          resp[3] = TF_NAK; // red za slanje je pun, neka master ponovi kasnije
+        else if (msg->data[2] == 1)
+          update.setStatus(ON);
         else if (msg->data[2] == 2)
-          stateFields[GroupStateFieldNames::STATUS] = "off";
+          update.setStatus(OFF);
         else
           resp[3] = TF_NAK; // nevalja podatak
 
@@ -199,7 +206,7 @@ TF_Result BINARY_SET_Listener(TinyFrame *tf, TF_Msg *msg)
         if (resp[3] != TF_NAK)
         {
           milightClient->prepare(MiLightRemoteType::REMOTE_TYPE_RGBW, adr, 1);
-          milightClient->update(stateFields.as<JsonObject>());
+          milightClient->update(update);
         }
         break;
       }
@@ -221,7 +228,7 @@ TF_Result DIMM_GET_Listener(TinyFrame *tf, TF_Msg *msg)
 TF_Result DIMM_SET_Listener(TinyFrame *tf, TF_Msg *msg)
 {
   uint8_t resp[4] = {0, 0, 0, TF_ACK};
-  StaticJsonDocument<50> stateFields;
+  StateUpdate update;
 
   // uzmi adresu
   uint16_t adr = (uint16_t)(msg->data[0] << 8) | msg->data[1];
@@ -234,8 +241,10 @@ TF_Result DIMM_SET_Listener(TinyFrame *tf, TF_Msg *msg)
       // provjeri za nule i adrese i daljiskog i da je adresiran registrovan daljinski
       if (adr == deviceId)
       {
-        if ((msg->data[2] >= 0) && (msg->data[2] <= 100))
-          stateFields[GroupStateFieldNames::LEVEL] = msg->data[2];
+        if (packetSender->isBackpressured())
+          resp[3] = TF_NAK; // red za slanje je pun, neka master ponovi kasnije
+        else if ((msg->data[2] >= 0) && (msg->data[2] <= 100))
+          update.setLevel(msg->data[2]);
         else
           resp[3] = TF_NAK; // nevalja podatak
 
@@ -247,7 +256,7 @@ TF_Result DIMM_SET_Listener(TinyFrame *tf, TF_Msg *msg)
         if (resp[3] != TF_NAK)
         {
           milightClient->prepare(MiLightRemoteType::REMOTE_TYPE_RGBW, adr, 1);
-          milightClient->update(stateFields.as<JsonObject>());
+          milightClient->update(update);
         }
       }
     }
@@ -273,7 +282,7 @@ TF_Result RGB_GET_Listener(TinyFrame *tf, TF_Msg *msg)
 TF_Result RGB_SET_Listener(TinyFrame *tf, TF_Msg *msg)
 {
   uint8_t resp[6] = {0};
-  StaticJsonDocument<50> stateFields;
+  StateUpdate update;
 
   // uzmi adresu
   uint16_t adr = (uint16_t)(msg->data[0] << 8) | msg->data[1];
@@ -287,18 +296,25 @@ TF_Result RGB_SET_Listener(TinyFrame *tf, TF_Msg *msg)
       if (adr == deviceId)
       {
         if ((msg->data[2] == 255) && (msg->data[3] == 255) && (msg->data[4] == 255))
-          stateFields[GroupStateFieldNames::COMMAND] = MiLightCommandNames::SET_WHITE;
+          update.addCommand(MiLightCommand::SET_WHITE);
         else
-          stateFields[GroupStateFieldNames::HUE] = ParsedColor::fromRgb(msg->data[2], msg->data[3], msg->data[4]).hue;
+          update.setHue(ParsedColor::fromRgb(msg->data[2], msg->data[3], msg->data[4]).hue);
 
         memcpy(resp, msg->data, 5); // kopiraj pet bajta u odgovor
         resp[5] = TF_ACK;           // pozicija 5 ACK bajta u odgovoru na komande set dimeru
+
+        if (packetSender->isBackpressured())
+          resp[5] = TF_NAK;         // red za slanje je pun, neka master ponovi kasnije
+
         msg->data = resp;
         msg->len = 6;
         TF_Respond(tf, msg); // Odgovaramo na komandu da ne ide resend bezveze
 
-        milightClient->prepare(MiLightRemoteType::REMOTE_TYPE_RGBW, adr, 1);
-        milightClient->update(stateFields.as<JsonObject>());
+        if (resp[5] != TF_NAK)
+        {
+          milightClient->prepare(MiLightRemoteType::REMOTE_TYPE_RGBW, adr, 1);
+          milightClient->update(update);
+        }
 
         break;
       }
@@ -312,6 +328,33 @@ TF_Result RGB_RESET_Listener(TinyFrame *tf, TF_Msg *msg)
   return TF_STAY;
 }
 
+TF_Result RGB_SCENE_Listener(TinyFrame *tf, TF_Msg *msg)
+{
+  uint8_t resp[3] = {0, 0, TF_ACK};
+
+  // uzmi id scene
+  uint16_t id = (uint16_t)(msg->data[0] << 8) | msg->data[1];
+  const Scene* scene = scenes.get(id);
+
+  memcpy(resp, msg->data, 2); // kopiraj id u odgovor
+
+  if (scene == NULL)
+    resp[2] = TF_NAK;         // nema te scene
+  else if (packetSender->isBackpressured())
+    resp[2] = TF_NAK;         // red za slanje je pun, neka master ponovi kasnije
+
+  msg->data = resp;
+  msg->len = 3;
+  TF_Respond(tf, msg); // Odgovaramo na komandu da ne ide resend bezveze
+
+  if (resp[2] != TF_NAK)
+  {
+    scenes.activate(*scene);
+  }
+
+  return TF_STAY; // Održavanje trenutnog stanja
+}
+
 
 
 
@@ -366,6 +409,10 @@ void onPacketSentHandler(uint8_t* packet, const MiLightRemoteConfig& config) {
   // set LED mode for a packet movement
   ledStatus->oneshot(settings.ledModePacket, settings.ledModePacketCount);
 
+  if (cctRecalibrator) {
+    cctRecalibrator->recordActivity();
+  }
+
   if (bulbId == DEFAULT_BULB_ID) {
     Serial.println(F("Skipping packet handler because packet was not decoded"));
     return;
@@ -403,24 +450,54 @@ void onPacketSentHandler(uint8_t* packet, const MiLightRemoteConfig& config) {
 }
 
 /**
- * Listen for packets on one radio config.  Cycles through all configs as its
- * called.
+ * Listen for packets on one radio config.  The config is chosen by the
+ * listen scheduler, which favors configs with traffic or configured remotes.
  */
 void handleListen() {
-  // Do not handle listens while there are packets enqueued to be sent
-  // Doing so causes the radio module to need to be reinitialized inbetween
-  // repeats, which slows things down.
-  if (! settings.listenRepeats || packetSender->isSending()) {
+  if (! settings.listenRepeats) {
+    return;
+  }
+
+  // Do not handle listens while there are packets enqueued to be sent, unless
+  // there's a separate radio to listen on.  Sharing the radio causes it to need
+  // to be reinitialized inbetween repeats, which slows things down.
+  if (packetSender->isSending() && ! radios->hasDedicatedListenRadio()) {
     return;
   }
 
-  std::shared_ptr<MiLightRadio> radio = radios->switchRadio(currentRadioType++ % radios->getNumRadios());
+  ListenScheduler& scheduler = radios->getListenScheduler();
+
+  // Packets the IRQ caught are still in the radio FIFO, and can only be decoded
+  // with the config they were received on.  Drain them before switching away.
+  size_t configIx = radios->irqPending() ? currentListenConfig : scheduler.nextConfig();
+  currentListenConfig = configIx;
+
+  std::shared_ptr<MiLightRadio> radio = radios->switchListenRadio(configIx);
+
+  if (radio == nullptr) {
+    return;
+  }
+
+  scheduler.recordPoll(configIx);
+
+  // With an IRQ there's no need to poll repeatedly waiting for a packet.  Just
+  // drain whatever has been signalled.
+  size_t maxReads = radios->hasIrq() ? MILIGHT_IRQ_RING_SIZE : settings.listenRepeats;
+
+  for (size_t i = 0; i < maxReads; i++) {
+    if (radios->hasIrq() && ! radios->irqPending() && i > 0) {
+      break;
+    }
 
-  for (size_t i = 0; i < settings.listenRepeats; i++) {
     if (radios->available()) {
       uint8_t readPacket[MILIGHT_MAX_PACKET_LENGTH];
       size_t packetLen = radios->read(readPacket);
 
+      // Echo of a packet we just sent
+      if (packetLen == 0) {
+        continue;
+      }
+
       const MiLightRemoteConfig* remoteConfig = MiLightRemoteConfig::fromReceivedPacket(
         radio->config(),
         readPacket,
@@ -432,7 +509,15 @@ void handleListen() {
 #ifdef DEBUG_PRINTF
         Serial.println(F("WARNING: Couldn't find remote for received packet"));
 #endif
-        return;
+        continue;
+      }
+
+      scheduler.recordHit(configIx);
+      packetSender->recordReceivedPacket(readPacket, *remoteConfig);
+
+      // Repeat of a button press that was already handled
+      if (radios->isRepeatedPacket(readPacket, *remoteConfig)) {
+        continue;
       }
 
       // update state to reflect this packet
@@ -465,6 +550,9 @@ void onUpdateEnd() {
  * Apply what's in the Settings object.
  */
 void applySettings() {
+  if (cctRecalibrator) {
+    delete cctRecalibrator;
+  }
   if (milightClient) {
     delete milightClient;
   }
@@ -495,7 +583,12 @@ void applySettings() {
 
   stateStore = new GroupStateStore(MILIGHT_MAX_STATE_ITEMS, settings.stateFlushInterval);
 
-  radios = new RadioSwitchboard(radioFactory, stateStore, settings);
+  radios = new RadioSwitchboard(
+    radioFactory,
+    stateStore,
+    settings,
+    MiLightRadioFactory::listenFromSettings(settings)
+  );
   packetSender = new PacketSender(*radios, settings, onPacketSentHandler);
 
   milightClient = new MiLightClient(
@@ -505,11 +598,15 @@ void applySettings() {
     settings,
     transitions
   );
+  transitions.setSink(milightClient);
+  transitions.setAirtimeSource([]() { return packetSender->getPacketServiceTime(); });
   milightClient->onUpdateBegin(onUpdateBegin);
   milightClient->onUpdateEnd(onUpdateEnd);
 
+  cctRecalibrator = new CctRecalibrator(*milightClient, *stateStore, *packetSender, settings);
+
   if (settings.mqttServer().length() > 0) {
-    mqttClient = new MqttClient(settings, milightClient);
+    mqttClient = new MqttClient(settings, milightClient, scenes);
     mqttClient->begin();
     mqttClient->onConnect([]() {
       if (settings.homeAssistantDiscoveryPrefix.length() > 0) {
@@ -595,6 +692,39 @@ void onGroupDeleted(const BulbId& id) {
   }
 }
 
+/**
+ * Service MQTT, UDP and discovery clients.
+ */
+void handleNetworkClients() {
+  if (mqttClient) {
+    mqttClient->handleClient();
+    bulbStateUpdater->loop();
+  }
+
+  for (auto & udpServer : udpServers) {
+    udpServer->handleClient();
+  }
+
+  if (discoveryServer) {
+    discoveryServer->handleClient();
+  }
+}
+
+/**
+ * Feed bytes from the RS485 bus into TinyFrame.
+ */
+void handleSerialInput() {
+  /*while (RS485.available())
+  {
+    TF_AcceptChar(tfapp, RS485.read());
+  }*/
+
+  while (Serial.available())
+  {
+    TF_AcceptChar(&tfapp, Serial.read());
+  }
+}
+
 bool initialized = false;
 void postConnectSetup() {
   if (initialized) return;
@@ -613,24 +743,18 @@ void postConnectSetup() {
   SSDP.setDeviceType("upnp:rootdevice");
   SSDP.begin();
 
-  httpServer = new MiLightHttpServer(settings, milightClient, stateStore, packetSender, radios, transitions);
+  httpServer = new MiLightHttpServer(settings, milightClient, stateStore, packetSender, radios, transitions, scenes);
   httpServer->onSettingsSaved(applySettings);
   httpServer->onGroupDeleted(onGroupDeleted);
+  httpServer->onBackgroundTasks([]() {
+    handleNetworkClients();
+    scenes.loop();
+    transitions.loop();
+    handleSerialInput();
+  });
   httpServer->on("/description.xml", HTTP_GET, []() { SSDP.schema(httpServer->client()); });
   httpServer->begin();
 
-  transitions.addListener(
-      [](const BulbId& bulbId, GroupStateField field, uint16_t value) {
-          StaticJsonDocument<100> buffer;
-
-          const char* fieldName = GroupStateFieldHelpers::getFieldName(field);
-          buffer[fieldName] = value;
-
-          milightClient->prepare(bulbId.deviceType, bulbId.deviceId, bulbId.groupId);
-          milightClient->update(buffer.as<JsonObject>());
-      }
-  );
-
   Serial.printf_P(PSTR("Setup complete (version %s)\n"), QUOTE(MILIGHT_HUB_VERSION));
 }
 
@@ -653,6 +777,7 @@ void setup() {
   TF_AddTypeListener(&tfapp, RGB_GET, RGB_GET_Listener);
   TF_AddTypeListener(&tfapp, RGB_SET, RGB_SET_Listener);
   TF_AddTypeListener(&tfapp, RGB_RESET, RGB_RESET_Listener);
+  TF_AddTypeListener(&tfapp, RGB_SCENE, RGB_SCENE_Listener);
 
   
 
@@ -661,6 +786,7 @@ void setup() {
   // load up our persistent settings from the file system
   ProjectFS.begin();
   Settings::load(settings);
+  scenes.load();
   applySettings();
 
   ESPMH_SETUP_WIFI(settings);
@@ -770,36 +896,19 @@ void loop() {
     postConnectSetup();
 
     httpServer->handleClient();
-    if (mqttClient) {
-      mqttClient->handleClient();
-      bulbStateUpdater->loop();
-    }
-
-    for (auto & udpServer : udpServers) {
-      udpServer->handleClient();
-    }
-
-    if (discoveryServer) {
-      discoveryServer->handleClient();
-    }
+    handleNetworkClients();
 
     handleListen();
 
     stateStore->limitedFlush();
     packetSender->loop();
 
+    scenes.loop();
     transitions.loop();
+    cctRecalibrator->handle();
   }
 
-  /*while (RS485.available())
-  {
-    TF_AcceptChar(tfapp, RS485.read());
-  }*/
-
-  while (Serial.available())
-  {
-    TF_AcceptChar(&tfapp, Serial.read());
-  }
+  handleSerialInput();
 }
 
 #endif
\ No newline at end of file
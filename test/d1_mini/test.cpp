@@ -10,7 +10,18 @@
 
 #include <RgbCctPacketFormatter.h>
 #include <FUT091PacketFormatter.h>
+#include <MiLightRemoteConfig.h>
+#include <V2RFEncoding.h>
 #include <Units.h>
+#include <ColorConversion.h>
+#include <RGBConverter.h>
+#include <RadioUtils.h>
+#include <RepeatLearner.h>
+#include <MiLightClient.h>
+#include <StateUpdate.h>
+#include <Scene.h>
+#include <SceneController.h>
+#include <TransitionController.h>
 
 #include "unity.h"
 
@@ -99,6 +110,87 @@ void test_fut091_packet_formatter() {
   );
 }
 
+void test_received_packet_remote_config() {
+  const MiLightRadioConfig& v2RadioConfig = FUT092Config.radioConfig;
+
+  uint8_t fut092Packet[] = {0x00, 0xDB, 0xE1, 0x24, 0x66, 0xCA, 0x54, 0x66, 0xD2};
+  TEST_ASSERT_TRUE_MESSAGE(
+    MiLightRemoteConfig::fromReceivedPacket(v2RadioConfig, fut092Packet, sizeof(fut092Packet)) == &FUT092Config,
+    "Should classify RGB+CCT packet"
+  );
+
+  uint8_t fut091Packet[] = {0x00, 0xDC, 0xE1, 0x24, 0x66, 0xCA, 0xBA, 0x66, 0xB5};
+  TEST_ASSERT_TRUE_MESSAGE(
+    MiLightRemoteConfig::fromReceivedPacket(v2RadioConfig, fut091Packet, sizeof(fut091Packet)) == &FUT091Config,
+    "Should classify FUT091 packet"
+  );
+
+  TEST_ASSERT_TRUE_MESSAGE(
+    MiLightRemoteConfig::fromReceivedPacket(v2RadioConfig, fut092Packet, 7) == NULL,
+    "Should not classify packet with wrong length"
+  );
+}
+
+void test_repeat_learner_recovers() {
+  RepeatLearner learner;
+  uint8_t sequenceNum = 0;
+
+  // Miss every other press for a while, then hear every press
+  learner.recordReceivedPacket(1, sequenceNum);
+  for (size_t i = 0; i < 8; ++i) {
+    sequenceNum += 2;
+    learner.recordReceivedPacket(1, sequenceNum);
+  }
+  TEST_ASSERT_EQUAL(100, learner.repeatsFor(1, 100, 1));
+
+  for (size_t i = 0; i < 40; ++i) {
+    learner.recordReceivedPacket(1, ++sequenceNum);
+  }
+
+  // A clean link should get all the way back to the minimum
+  TEST_ASSERT_EQUAL(RepeatLearner::MIN_REPEAT_PERCENT, learner.repeatsFor(1, 100, 1));
+}
+
+void test_v2_rf_encoding_tables() {
+  // Captured packets from the formatter tests above, plus one random packet
+  uint8_t vectors[][V2_PACKET_LEN] = {
+    {0x00, 0xDB, 0xE1, 0x24, 0x66, 0xCA, 0x54, 0x66, 0xD2},
+    {0x00, 0xDB, 0xE1, 0x24, 0x64, 0x3C, 0x47, 0x66, 0x31},
+    {0x00, 0xDB, 0xE1, 0x24, 0x64, 0x94, 0x62, 0x66, 0x88},
+    {0x00, 0xDC, 0xE1, 0x24, 0x66, 0xCA, 0xBA, 0x66, 0xB5},
+    {0x00, 0xDC, 0xE1, 0x24, 0x64, 0x8D, 0xB9, 0x66, 0x71},
+    {0x00, 0xDC, 0xE1, 0x24, 0x64, 0x55, 0xB7, 0x66, 0x27},
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+  };
+  const size_t numVectors = sizeof(vectors) / sizeof(vectors[0]);
+
+  randomSeed(0);
+  for (size_t i = 1; i < V2_PACKET_LEN; i++) {
+    vectors[numVectors - 1][i] = random(256);
+  }
+
+  for (size_t key = 0; key < 256; key++) {
+    TEST_ASSERT_EQUAL_INT_MESSAGE(V2RFEncoding::xorKeySerial(key), V2RFEncoding::xorKey(key), "XOR key table should match computed key");
+
+    for (size_t v = 0; v < numVectors; v++) {
+      uint8_t expected[V2_PACKET_LEN];
+      uint8_t actual[V2_PACKET_LEN];
+
+      memcpy(expected, vectors[v], V2_PACKET_LEN);
+      expected[0] = key;
+      memcpy(actual, expected, V2_PACKET_LEN);
+
+      V2RFEncoding::decodeV2PacketSerial(expected);
+      V2RFEncoding::decodeV2Packet(actual);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected, actual, V2_PACKET_LEN, "Table decode should match computed decode");
+
+      V2RFEncoding::encodeV2PacketSerial(expected);
+      V2RFEncoding::encodeV2Packet(actual);
+      TEST_ASSERT_EQUAL_UINT8_ARRAY_MESSAGE(expected, actual, V2_PACKET_LEN, "Table encode should match computed encode");
+    }
+  }
+}
+
 //================================================================================
 // Group State
 //================================================================================
@@ -340,6 +432,549 @@ void test_group_0() {
   TEST_ASSERT_TRUE_MESSAGE(storedState.isEqualIgnoreDirty(rgbState), "Should persist group 0 for device type with no groups");
 }
 
+void apply_packet_command(GroupState& state, const char* command) {
+  StaticJsonDocument<64> doc;
+  doc[GroupStateFieldNames::COMMAND] = command;
+
+  const GroupState update(&state, doc.as<JsonObject>());
+  state.patch(update);
+}
+
+void test_step_position_confidence() {
+  GroupState s;
+
+  for (size_t i = 0; i < 9; i++) {
+    apply_packet_command(s, "brightness_down");
+  }
+  TEST_ASSERT_FALSE_MESSAGE(s.isStepPositionTrusted(GroupStateField::BRIGHTNESS), "Partial run from unknown position should not be trusted");
+
+  apply_packet_command(s, "brightness_down");
+  TEST_ASSERT_EQUAL(0, s.getBrightness());
+  TEST_ASSERT_EQUAL_MESSAGE(StepPositionSource::CALIBRATED, s.getStepPositionSource(GroupStateField::BRIGHTNESS), "Full run should calibrate");
+  TEST_ASSERT_TRUE(s.isStepPositionTrusted(GroupStateField::BRIGHTNESS));
+
+  for (size_t i = 0; i < 3; i++) {
+    apply_packet_command(s, "brightness_up");
+  }
+  TEST_ASSERT_EQUAL(30, s.getBrightness());
+  TEST_ASSERT_EQUAL(StepPositionSource::TRACKED, s.getStepPositionSource(GroupStateField::BRIGHTNESS));
+  TEST_ASSERT_EQUAL(3, s.getStepsSinceCalibration(GroupStateField::BRIGHTNESS));
+  TEST_ASSERT_TRUE(s.isStepPositionTrusted(GroupStateField::BRIGHTNESS));
+
+  for (size_t i = 3; i < MILIGHT_STEP_POSITION_MAX_STEPS; i++) {
+    apply_packet_command(s, i % 2 == 0 ? "brightness_up" : "brightness_down");
+  }
+  TEST_ASSERT_FALSE_MESSAGE(s.isStepPositionTrusted(GroupStateField::BRIGHTNESS), "Too many relative steps should not be trusted");
+  TEST_ASSERT_FALSE_MESSAGE(s.isStepPositionTrusted(GroupStateField::KELVIN), "Untouched field should not be trusted");
+
+  for (size_t i = 0; i < 10; i++) {
+    apply_packet_command(s, "brightness_up");
+  }
+  TEST_ASSERT_EQUAL(100, s.getBrightness());
+  TEST_ASSERT_TRUE_MESSAGE(s.isStepPositionTrusted(GroupStateField::BRIGHTNESS), "Full run should recalibrate");
+
+  s.invalidateStepPosition(GroupStateField::BRIGHTNESS);
+  TEST_ASSERT_FALSE(s.isStepPositionTrusted(GroupStateField::BRIGHTNESS));
+}
+
+void test_state_update_from_json() {
+  StaticJsonDocument<256> doc;
+  deserializeJson(doc, F("{\"state\":\"ON\",\"brightness\":128,\"color_temp\":300,\"effect\":\"night_mode\",\"commands\":[\"level_up\",{\"command\":\"transition\"},\"toggle\"],\"transition\":2}"));
+
+  StateUpdate update = StateUpdate::fromJson(doc.as<JsonObject>());
+
+  TEST_ASSERT_TRUE(update.has(StateUpdate::STATUS));
+  TEST_ASSERT_EQUAL(ON, update.status);
+  TEST_ASSERT_TRUE(update.has(StateUpdate::BRIGHTNESS));
+  TEST_ASSERT_EQUAL(128, update.brightness);
+  TEST_ASSERT_FALSE(update.has(StateUpdate::LEVEL));
+  TEST_ASSERT_TRUE(update.has(StateUpdate::COLOR_TEMP));
+  TEST_ASSERT_EQUAL(300, update.colorTemp);
+  TEST_ASSERT_TRUE(update.has(StateUpdate::EFFECT));
+  TEST_ASSERT_EQUAL(MiLightCommand::NIGHT_MODE, update.effect);
+  TEST_ASSERT_TRUE(update.has(StateUpdate::TRANSITION));
+  TEST_ASSERT_EQUAL_FLOAT(2, update.transition);
+
+  TEST_ASSERT_EQUAL_MESSAGE(2, update.numCommands, "Transition command should be left to the JSON caller");
+  TEST_ASSERT_EQUAL(MiLightCommand::LEVEL_UP, update.commands[0]);
+  TEST_ASSERT_EQUAL(MiLightCommand::TOGGLE, update.commands[1]);
+}
+
+void test_state_update_key_dispatch() {
+  StaticJsonDocument<256> doc;
+  deserializeJson(doc, F("{\"temperature\":20,\"state\":\"OFF\",\"kelvin\":80,\"status\":\"ON\",\"effect\":\"3\",\"mode\":1,\"unknown_key\":1,\"argument\":5,\"button_id\":2}"));
+
+  StateUpdate update = StateUpdate::fromJson(doc.as<JsonObject>());
+
+  TEST_ASSERT_EQUAL_MESSAGE(ON, update.status, "status should take precedence over state");
+  TEST_ASSERT_EQUAL_MESSAGE(20, update.kelvin, "temperature should take precedence over kelvin");
+  TEST_ASSERT_EQUAL_MESSAGE(3, update.mode, "numeric effect should take precedence over mode");
+  TEST_ASSERT_TRUE(update.has(StateUpdate::RAW_COMMAND));
+  TEST_ASSERT_EQUAL(2, update.buttonId);
+  TEST_ASSERT_EQUAL(5, update.argument);
+
+  MiLightCommand command;
+  TEST_ASSERT_TRUE(StateUpdate::parseCommand("brightness_down", command));
+  TEST_ASSERT_EQUAL(MiLightCommand::LEVEL_DOWN, command);
+  TEST_ASSERT_FALSE(StateUpdate::parseCommand(MiLightCommandNames::TRANSITION, command));
+  TEST_ASSERT_FALSE(StateUpdate::parseCommand("", command));
+
+  for (uint8_t i = 0; i <= static_cast<uint8_t>(GroupStateField::COLOR_MODE); ++i) {
+    GroupStateField field = static_cast<GroupStateField>(i);
+    TEST_ASSERT_EQUAL_MESSAGE(field, GroupStateFieldHelpers::getFieldByName(GroupStateFieldHelpers::getFieldName(field)), "Field names should round trip");
+  }
+  TEST_ASSERT_EQUAL(GroupStateField::UNKNOWN, GroupStateFieldHelpers::getFieldByName("not_a_field"));
+}
+
+//================================================================================
+// Client
+//================================================================================
+
+// Radio that drops everything sent to it, so that packets stay queued
+class NullRadio : public MiLightRadio {
+public:
+  NullRadio(const MiLightRadioConfig& config) : radioConfig(config) { }
+
+  int begin() { return 0; }
+  bool available() { return false; }
+  int read(uint8_t frame[], size_t& frame_length) { frame_length = 0; return -1; }
+  int write(uint8_t frame[], size_t frame_length) { return 0; }
+  int resend() { return 0; }
+  int configure() { return 0; }
+  const MiLightRadioConfig& config() { return radioConfig; }
+  MiLightRadioStats stats() const { return MiLightRadioStats(); }
+
+private:
+  const MiLightRadioConfig& radioConfig;
+};
+
+class NullRadioFactory : public MiLightRadioFactory {
+public:
+  std::shared_ptr<MiLightRadio> create(const MiLightRadioConfig& config) {
+    return std::make_shared<NullRadio>(config);
+  }
+};
+
+void test_noop_suppression_waits_for_queue() {
+  Settings settings;
+  settings.noopSuppressionMaxAge = 60;
+
+  GroupStateStore stateStore(10, 0);
+  RadioSwitchboard radios(std::make_shared<NullRadioFactory>(), &stateStore, settings);
+  PacketSender packetSender(radios, settings, nullptr);
+  TransitionController transitions;
+  MiLightClient client(radios, packetSender, &stateStore, settings, transitions);
+
+  BulbId bulbId(1, 1, REMOTE_TYPE_RGB_CCT);
+  GroupState state;
+  state.setState(ON);
+  stateStore.set(bulbId, state);
+
+  client.prepare(bulbId.deviceType, bulbId.deviceId, bulbId.groupId);
+
+  // Nothing queued, so known state is current and ON is a no-op
+  client.update(StateUpdate().setStatus(ON));
+  TEST_ASSERT_EQUAL(0, packetSender.queueLength());
+  TEST_ASSERT_EQUAL(1, client.getSuppressedPackets());
+
+  // Known state is still ON while the OFF is queued.  The ON after it must be sent.
+  client.update(StateUpdate().setStatus(OFF));
+  size_t queued = packetSender.queueLength();
+  TEST_ASSERT_TRUE(queued > 0);
+
+  client.update(StateUpdate().setStatus(ON));
+  TEST_ASSERT_TRUE(packetSender.queueLength() > queued);
+  TEST_ASSERT_EQUAL(1, client.getSuppressedPackets());
+
+  // Only packets for the same device count.  The first target still has commands
+  // queued so its ON is sent, but the second target's is a no-op.
+  BulbId other(2, 1, REMOTE_TYPE_RGB_CCT);
+  stateStore.set(other, state);
+  queued = packetSender.queueLength();
+
+  client.update(StateUpdate().setStatus(ON), std::vector<BulbId>{bulbId, other});
+  TEST_ASSERT_TRUE(packetSender.queueLength() > queued);
+  TEST_ASSERT_EQUAL(2, client.getSuppressedPackets());
+}
+
+//================================================================================
+// Scenes
+//================================================================================
+
+void test_scene_state_from_update() {
+  StaticJsonDocument<128> doc;
+  deserializeJson(doc, F("{\"state\":\"ON\",\"brightness\":255,\"color_temp\":370}"));
+
+  SceneState state = SceneState::fromUpdate(StateUpdate::fromJson(doc.as<JsonObject>()));
+
+  TEST_ASSERT_EQUAL(SceneState::STATUS | SceneState::LEVEL | SceneState::KELVIN, state.fields);
+  TEST_ASSERT_EQUAL(ON, state.status);
+  TEST_ASSERT_EQUAL(100, state.level);
+  TEST_ASSERT_EQUAL(100, state.kelvin);
+
+  // White colors and the white mode effect switch to white, rather than to red
+  deserializeJson(doc, F("{\"color\":\"#FFFFFF\"}"));
+  state = SceneState::fromUpdate(StateUpdate::fromJson(doc.as<JsonObject>()));
+  TEST_ASSERT_EQUAL(SceneState::WHITE_MODE, state.fields);
+
+  deserializeJson(doc, F("{\"effect\":\"white_mode\"}"));
+  state = SceneState::fromUpdate(StateUpdate::fromJson(doc.as<JsonObject>()));
+  TEST_ASSERT_EQUAL(SceneState::WHITE_MODE, state.fields);
+}
+
+void test_scene_plan_member() {
+  SceneMember member;
+  member.bulbId = BulbId(1, 1, REMOTE_TYPE_RGB_CCT);
+  member.state.fields = SceneState::STATUS | SceneState::HUE | SceneState::SATURATION | SceneState::LEVEL;
+  member.state.status = ON;
+  member.state.hue = 121;
+  member.state.saturation = 80;
+  member.state.level = 50;
+
+  // Unknown state gets every field
+  TEST_ASSERT_EQUAL(
+    SceneController::PHASE_ON | SceneController::PHASE_HUE | SceneController::PHASE_SATURATION | SceneController::PHASE_LEVEL,
+    SceneController::planMember(member, NULL)
+  );
+
+  GroupState current;
+  current.setState(ON);
+  current.setBulbMode(BULB_MODE_COLOR);
+  current.setHue(120);
+  current.setSaturation(80);
+  current.setBrightness(50);
+
+  // Already there.  Hue only has 8 bits of precision, so is compared to within a degree.
+  TEST_ASSERT_EQUAL(0, SceneController::planMember(member, &current));
+
+  current.setSaturation(20);
+  TEST_ASSERT_EQUAL(SceneController::PHASE_SATURATION, SceneController::planMember(member, &current));
+
+  // Brightness is per bulb mode, so switching to white resends it
+  member.state.fields = SceneState::STATUS | SceneState::KELVIN | SceneState::LEVEL;
+  member.state.kelvin = 40;
+  TEST_ASSERT_EQUAL(SceneController::PHASE_WHITE | SceneController::PHASE_LEVEL, SceneController::planMember(member, &current));
+
+  // White mode without a temperature only needs the mode to match
+  member.state.fields = SceneState::STATUS | SceneState::WHITE_MODE;
+  TEST_ASSERT_EQUAL(SceneController::PHASE_WHITE, SceneController::planMember(member, &current));
+  current.setBulbMode(BULB_MODE_WHITE);
+  TEST_ASSERT_EQUAL(0, SceneController::planMember(member, &current));
+  current.setBulbMode(BULB_MODE_COLOR);
+  member.state.fields = SceneState::STATUS | SceneState::KELVIN | SceneState::LEVEL;
+
+  // Off excludes everything else, and is skipped if the bulb is known to be off
+  member.state.status = OFF;
+  TEST_ASSERT_EQUAL(SceneController::PHASE_OFF, SceneController::planMember(member, &current));
+  current.setState(OFF);
+  TEST_ASSERT_EQUAL(0, SceneController::planMember(member, &current));
+}
+
+void test_scene_file_round_trip() {
+  std::map<uint16_t, Scene> scenes;
+
+  for (uint16_t id = 1; id <= 3; ++id) {
+    Scene scene;
+    scene.id = id;
+    scene.setName(id == 2 ? "" : "a scene name that is much too long to be stored");
+
+    for (uint8_t groupId = 1; groupId <= id; ++groupId) {
+      SceneMember member;
+      member.bulbId = BulbId(0x1234 + id, groupId, REMOTE_TYPE_RGB_CCT);
+      member.state.fields = SceneState::STATUS | SceneState::HUE | SceneState::LEVEL;
+      member.state.status = groupId % 2 ? ON : OFF;
+      member.state.hue = 300 + groupId;
+      member.state.level = 10 * groupId;
+      scene.members.push_back(member);
+    }
+
+    scenes[id] = scene;
+  }
+
+  File f = ProjectFS.open("/test_scenes.bin", "w");
+  Scene::saveScenes(f, scenes);
+  f.close();
+
+  std::map<uint16_t, Scene> loaded;
+  f = ProjectFS.open("/test_scenes.bin", "r");
+  Scene::loadScenes(f, loaded);
+  f.close();
+  ProjectFS.remove("/test_scenes.bin");
+
+  TEST_ASSERT_EQUAL(scenes.size(), loaded.size());
+
+  for (auto& it : scenes) {
+    const Scene& expected = it.second;
+    const Scene& actual = loaded[it.first];
+
+    TEST_ASSERT_EQUAL_STRING(expected.name, actual.name);
+    TEST_ASSERT_EQUAL(expected.members.size(), actual.members.size());
+
+    for (size_t i = 0; i < expected.members.size(); ++i) {
+      const SceneMember& e = expected.members[i];
+      const SceneMember& a = actual.members[i];
+
+      TEST_ASSERT_EQUAL(e.bulbId.deviceId, a.bulbId.deviceId);
+      TEST_ASSERT_EQUAL(e.bulbId.groupId, a.bulbId.groupId);
+      TEST_ASSERT_EQUAL(e.bulbId.deviceType, a.bulbId.deviceType);
+      TEST_ASSERT_EQUAL(e.state.fields, a.state.fields);
+      TEST_ASSERT_EQUAL(e.state.status, a.state.status);
+      TEST_ASSERT_EQUAL(e.state.hue, a.state.hue);
+      TEST_ASSERT_EQUAL(e.state.level, a.state.level);
+    }
+  }
+}
+
+void test_scene_file_long_name() {
+  // A name longer than MAX_SCENE_NAME_LEN is truncated, and the rest skipped
+  const uint8_t nameLength = MAX_SCENE_NAME_LEN + 8;
+  const uint8_t member[] = {0x34, 0x12, 1, REMOTE_TYPE_RGB_CCT, SceneState::STATUS, ON, 0, 0, 0, 0, 0, 0};
+
+  File f = ProjectFS.open("/test_scenes.bin", "w");
+  f.write("SC\x01\x02", 4);
+
+  for (uint16_t id = 1; id <= 2; ++id) {
+    f.write(id & 0xFF);
+    f.write(id >> 8);
+    f.write(nameLength);
+    for (size_t i = 0; i < nameLength; ++i) {
+      f.write('a');
+    }
+    f.write(1);
+    f.write(member, sizeof(member));
+  }
+  f.close();
+
+  std::map<uint16_t, Scene> loaded;
+  f = ProjectFS.open("/test_scenes.bin", "r");
+  Scene::loadScenes(f, loaded);
+  f.close();
+  ProjectFS.remove("/test_scenes.bin");
+
+  TEST_ASSERT_EQUAL(2, loaded.size());
+  TEST_ASSERT_EQUAL(MAX_SCENE_NAME_LEN, strlen(loaded[2].name));
+  TEST_ASSERT_EQUAL(1, loaded[2].members.size());
+  TEST_ASSERT_EQUAL(0x1234, loaded[2].members[0].bulbId.deviceId);
+}
+
+//================================================================================
+// Transitions
+//================================================================================
+
+void test_transition_schedule() {
+  TransitionController controller;
+  BulbId bulbId(1, 1, REMOTE_TYPE_RGB_CCT);
+  std::vector<uint16_t> steps;
+
+  controller.addListener([&steps](const BulbId&, GroupStateField, uint16_t value) { steps.push_back(value); });
+
+  auto slow = controller.buildFieldTransition(bulbId, GroupStateField::LEVEL, 0, 100);
+  slow->setPeriod(60000);
+  auto fast = controller.buildFieldTransition(bulbId, GroupStateField::LEVEL, 50, 51);
+  fast->setPeriod(1);
+
+  controller.addTransition(slow->build());
+  controller.addTransition(fast->build());
+  TEST_ASSERT_EQUAL(2, controller.getNumActive());
+
+  // Both are due immediately
+  controller.loop();
+  TEST_ASSERT_EQUAL(2, steps.size());
+
+  // Only the fast one is due again.  It finishes while the slow one waits.
+  for (size_t i = 0; i < 10; ++i) {
+    delay(2);
+    controller.loop();
+  }
+  TEST_ASSERT_EQUAL(1, controller.getNumActive());
+  TEST_ASSERT_EQUAL(51, steps.back());
+
+  const size_t slowId = controller.getTransitions().front().transition->id;
+  TEST_ASSERT_NOT_NULL(controller.getTransition(slowId));
+  TEST_ASSERT_TRUE(controller.deleteTransition(slowId));
+  TEST_ASSERT_FALSE(controller.deleteTransition(slowId));
+  TEST_ASSERT_EQUAL(0, controller.getNumActive());
+}
+
+void test_group_transition_lockstep() {
+  TransitionController controller;
+  std::vector<BulbId> members = {
+    BulbId(1, 1, REMOTE_TYPE_RGB_CCT),
+    BulbId(1, 2, REMOTE_TYPE_RGB_CCT),
+    BulbId(2, 1, REMOTE_TYPE_FUT089)
+  };
+  std::vector<BulbId> sentTo;
+  std::vector<uint16_t> values;
+
+  controller.addListener([&](const BulbId& bulbId, GroupStateField field, uint16_t value) {
+    sentTo.push_back(bulbId);
+    values.push_back(value);
+  });
+
+  auto builder = controller.buildGroupTransition(
+    members,
+    controller.buildFieldTransition(members.front(), GroupStateField::LEVEL, 10, 20)
+  );
+  builder->setPeriod(60000);
+  controller.addTransition(builder->build());
+
+  TEST_ASSERT_EQUAL(1, controller.getNumActive());
+
+  controller.loop();
+
+  // One step, sent to every member with the same value
+  TEST_ASSERT_EQUAL(members.size(), sentTo.size());
+  for (size_t i = 0; i < members.size(); ++i) {
+    TEST_ASSERT_TRUE(members[i] == sentTo[i]);
+    TEST_ASSERT_EQUAL(10, values[i]);
+  }
+
+  // Turning a group on turns every member on up front
+  sentTo.clear();
+  controller.buildStatusTransition(members, ON, 0);
+  TEST_ASSERT_EQUAL(members.size(), sentTo.size());
+}
+
+void test_transition_airtime_budget() {
+  TransitionController controller;
+  BulbId bulbId(1, 1, REMOTE_TYPE_RGB_CCT);
+  std::vector<uint16_t> steps;
+
+  controller.addListener([&steps](const BulbId&, GroupStateField, uint16_t value) { steps.push_back(value); });
+
+  // 20ms per packet leaves room for 37.5 packets/s.  A 10ms period wants 100.
+  controller.setAirtimeSource([]() { return 20000; });
+
+  auto builder = controller.buildFieldTransition(bulbId, GroupStateField::LEVEL, 0, 100);
+  builder->setDuration(1);
+  builder->setPeriod(10);
+  controller.addTransition(builder->build());
+
+  TEST_ASSERT_EQUAL(100, controller.getDemand());
+  TEST_ASSERT_EQUAL(37, controller.getBudget());
+  TEST_ASSERT_EQUAL(3, controller.getStride());
+
+  // Steps are three times as large and three times as far apart
+  controller.loop();
+  delay(15);
+  controller.loop();
+  TEST_ASSERT_EQUAL(1, steps.size());
+  delay(20);
+  controller.loop();
+  TEST_ASSERT_EQUAL(2, steps.size());
+  TEST_ASSERT_EQUAL(3, steps.back() - steps.front());
+
+  TEST_ASSERT_TRUE(controller.deleteTransition(controller.getTransitions().front().transition->id));
+  TEST_ASSERT_EQUAL(0, controller.getDemand());
+  TEST_ASSERT_EQUAL(1, controller.getStride());
+}
+
+//================================================================================
+// Color conversion
+//
+// The integer conversions should stay within one unit of the float versions they
+// replaced.
+//================================================================================
+
+static uint16_t floatRescale(uint16_t value, uint16_t newMax, float oldMax) {
+  return round(value * (newMax / oldMax));
+}
+
+void test_rescale_matches_float() {
+  const uint16_t ranges[][2] = {
+    {255, 360}, {360, 255}, {100, 255}, {255, 100}, {25, 100}, {100, 25}, {255, 25},
+    {COLOR_TEMP_MAX_MIREDS - COLOR_TEMP_MIN_MIREDS, 255}, {255, COLOR_TEMP_MAX_MIREDS - COLOR_TEMP_MIN_MIREDS}
+  };
+
+  for (auto& range : ranges) {
+    for (uint16_t value = 0; value <= range[1]; ++value) {
+      const int expected = floatRescale(value, range[0], range[1]);
+      const int actual = Units::rescale<uint16_t, uint16_t>(value, range[0], range[1]);
+
+      TEST_ASSERT_INT_WITHIN(1, expected, actual);
+    }
+  }
+}
+
+void test_mireds_conversion_matches_float() {
+  const uint16_t whiteRange = COLOR_TEMP_MAX_MIREDS - COLOR_TEMP_MIN_MIREDS;
+
+  for (uint16_t mireds = 0; mireds < 600; ++mireds) {
+    const uint16_t clamped = constrain(mireds, COLOR_TEMP_MIN_MIREDS, COLOR_TEMP_MAX_MIREDS) - COLOR_TEMP_MIN_MIREDS;
+
+    TEST_ASSERT_INT_WITHIN(1, floatRescale(clamped, 100, whiteRange), Units::miredsToWhiteVal(mireds, 100));
+    TEST_ASSERT_INT_WITHIN(1, floatRescale(clamped, 255, whiteRange), Units::miredsToWhiteVal(mireds));
+  }
+
+  for (uint16_t value = 0; value <= 255; ++value) {
+    TEST_ASSERT_INT_WITHIN(1, COLOR_TEMP_MIN_MIREDS + floatRescale(value, whiteRange, 255), Units::whiteValToMireds(value));
+  }
+}
+
+void test_rgb_to_hsv_matches_float() {
+  RGBConverter converter;
+  double hsv[3];
+  uint16_t hue;
+  uint8_t saturation;
+
+  // Every third channel value (including 0 and 255) keeps the float side to a few seconds
+  for (uint16_t r = 0; r <= 255; r += 3) {
+    for (uint16_t g = 0; g <= 255; g += 3) {
+      for (uint16_t b = 0; b <= 255; b += 3) {
+        converter.rgbToHsv(r, g, b, hsv);
+        ColorConversion::rgbToHsv(r, g, b, hue, saturation);
+
+        TEST_ASSERT_INT_WITHIN(1, round(hsv[0] * 360), hue);
+        TEST_ASSERT_INT_WITHIN(1, round(hsv[1] * 100), saturation);
+      }
+    }
+    yield();
+  }
+}
+
+void test_hsv_to_rgb_matches_float() {
+  RGBConverter converter;
+  uint8_t expected[3];
+  uint8_t actual[3];
+
+  for (uint16_t hue = 0; hue <= 360; ++hue) {
+    for (uint8_t saturation = 0; saturation <= 100; ++saturation) {
+      converter.hsvToRgb(hue / 360.0, saturation / 100.0, 1, expected);
+      ColorConversion::hsvToRgb(hue, saturation, actual);
+
+      for (size_t i = 0; i < 3; ++i) {
+        TEST_ASSERT_INT_WITHIN(1, expected[i], actual[i]);
+      }
+    }
+    yield();
+  }
+}
+
+//================================================================================
+// Radio utils
+//================================================================================
+
+void test_reverse_bits_table() {
+  for (size_t i = 0; i < 256; i++) {
+    TEST_ASSERT_EQUAL_INT_MESSAGE(reverseBitsSerial(i), reverseBits(i), "Lookup table should match bit-serial reverseBits");
+  }
+}
+
+void test_pl1167_crc_table() {
+  uint8_t packet[16];
+  randomSeed(0);
+
+  for (size_t i = 0; i < 1000; i++) {
+    size_t length = random(0, sizeof(packet) + 1);
+
+    for (size_t j = 0; j < length; j++) {
+      packet[j] = random(0, 256);
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(pl1167CrcSerial(packet, length), pl1167Crc(packet, length), "Table CRC should match bit-serial CRC");
+  }
+}
+
 // setup connects serial, runs test cases (upcoming)
 void setup() {
   delay(2000);
@@ -354,9 +989,34 @@ void setup() {
   RUN_TEST(test_persistence);
   RUN_TEST(test_store);
   RUN_TEST(test_group_0);
+  RUN_TEST(test_step_position_confidence);
+  RUN_TEST(test_state_update_from_json);
+  RUN_TEST(test_state_update_key_dispatch);
+
+  RUN_TEST(test_noop_suppression_waits_for_queue);
+
+  RUN_TEST(test_scene_state_from_update);
+  RUN_TEST(test_scene_file_round_trip);
+  RUN_TEST(test_scene_file_long_name);
+  RUN_TEST(test_scene_plan_member);
+
+  RUN_TEST(test_transition_schedule);
+  RUN_TEST(test_group_transition_lockstep);
+  RUN_TEST(test_transition_airtime_budget);
+
+  RUN_TEST(test_rescale_matches_float);
+  RUN_TEST(test_mireds_conversion_matches_float);
+  RUN_TEST(test_rgb_to_hsv_matches_float);
+  RUN_TEST(test_hsv_to_rgb_matches_float);
 
   RUN_TEST(test_fut091_packet_formatter);
   RUN_TEST(test_fut092_packet_formatter);
+  RUN_TEST(test_received_packet_remote_config);
+  RUN_TEST(test_v2_rf_encoding_tables);
+  RUN_TEST(test_repeat_learner_recovers);
+
+  RUN_TEST(test_reverse_bits_table);
+  RUN_TEST(test_pl1167_crc_table);
 
   UNITY_END();
 }
@@ -190,6 +190,12 @@ var UI_FIELDS = [ {
     help: "Connection status messages will be published to this topic.  This includes LWT and birth.  See README for further detail.",
     type: "string",
     tab: "tab-mqtt"
+  }, {
+    tag:   "mqtt_scene_topic",
+    friendly: "MQTT Scene Topic",
+    help: "Publish the id or name of a stored scene to this topic to activate it.",
+    type: "string",
+    tab: "tab-mqtt"
   }, {
     tag:   "mqtt_retain",
     friendly: "Publish state messages with retain flag",
@@ -226,6 +232,41 @@ var UI_FIELDS = [ {
       'LT8900': 'PL1167/LT8900'
     },
     tab: "tab-radio"
+  }, {
+    tag:   "listen_radio_interface_type",
+    friendly: "Listen radio interface type",
+    help: "Optional second radio used only for listening. Lets the gateway hear remotes while it is sending.",
+    type: "option_buttons",
+    options: {
+      'none': 'None',
+      'nRF24': 'nRF24',
+      'LT8900': 'PL1167/LT8900'
+    },
+    tab: "tab-radio"
+  }, {
+    tag: "listen_ce_pin",
+    friendly: "Listen radio CE pin",
+    help: "Pin on ESP8266 used for the listen radio's 'CE' (PKT_FLAG for LT8900)",
+    type: "string",
+    tab: "tab-radio"
+  }, {
+    tag: "listen_csn_pin",
+    friendly: "Listen radio CSN pin",
+    help: "Pin on ESP8266 used for the listen radio's 'CSN'. Must differ from the main CSN pin and from GPIO5 (RS485 driver enable). Defaults to GPIO15.",
+    type: "string",
+    tab: "tab-radio"
+  }, {
+    tag: "listen_reset_pin",
+    friendly: "Listen radio RESET pin",
+    help: "Pin on ESP8266 used for the listen radio's 'RESET' (LT8900 only)",
+    type: "string",
+    tab: "tab-radio"
+  }, {
+    tag: "radio_irq_pin",
+    friendly: "Radio IRQ pin",
+    help: "Pin on ESP8266 connected to the receiving radio's 'IRQ' (nRF24) or 'PKT_FLAG' (LT8900). Set to -1 to poll the radio instead.",
+    type: "string",
+    tab: "tab-radio"
   }, {
     tag:   "rf24_power_level",
     friendly: "nRF24 Power Level",
@@ -313,6 +354,17 @@ var UI_FIELDS = [ {
     "of repeated packets (defaults to 3)",
     type: "string",
     tab: "tab-radio"
+  }, {
+    tag:   "adaptive_packet_repeats",
+    friendly: "Adaptive packet repeats",
+    help: "Send fewer repeats to device IDs whose remotes are reliably heard while listening.  " +
+    "Falls back to the full repeat count for device IDs that haven't been heard from recently.",
+    type: "option_buttons",
+    options: {
+      true: 'Enable',
+      false: 'Disable'
+    },
+    tab: "tab-radio"
   }, {
     tag:   "group_state_fields",
     friendly: "Group state fields",
@@ -331,6 +383,20 @@ var UI_FIELDS = [ {
       false: 'Disable'
     },
     tab: "tab-radio"
+  }, {
+    tag:   "cct_recalibrate_interval",
+    friendly: "CCT recalibration interval (minutes)",
+    help: "CCT bulbs that are off and haven't been calibrated in this long are briefly turned on, driven to " +
+    "a known brightness and temperature, and turned back off while the hub is idle.  Set to 0 to disable.",
+    type: "string",
+    tab: "tab-radio"
+  }, {
+    tag:   "noop_suppression_max_age",
+    friendly: "Skip no-op commands (seconds)",
+    help: "Don't send commands that wouldn't change a bulb's known state, provided that state was confirmed by a " +
+    "packet within this many seconds.  Set to 0 to disable.",
+    type: "string",
+    tab: "tab-radio"
   }, {
     tag:   "led_mode_wifi_config",
     friendly: "LED mode during wifi config",